@@ -2,11 +2,104 @@ import numpy as np
 import random
 import matplotlib.pyplot as plt
 
+# Estados de energia de um pool EPM/CPM (ver oran-pool-power-state.h)
+DESLIGADO, INICIANDO, LIGADO = 0, 1, 2
+
+# Custos de ligar e desligar um pool
+POWER_STATES = {
+    "wake_delay": 20.0,        # Tempo de inicialização (s)
+    "boot_factor": 1.0,        # Potência durante a inicialização, relativa à estática
+    "wake_energy": 1000.0,     # Energia extra de cada transição desligado -> ligado (J)
+    "shutdown_energy": 200.0,  # Energia de cada transição ligado -> desligado (J)
+    "idle_timeout": 30.0,      # Tempo que um pool sem carga fica ligado antes de desligar (s)
+}
+
+
+def pool_states_energy(L, estado, restante, P, P_prime, C, T, cfg=POWER_STATES):
+    """
+    Energia dos pools no intervalo considerando os estados desligado,
+    iniciando e ligado, em vez de desligar a potência estática quando L == 0.
+
+    Parâmetros:
+    L (numpy.array): Carga computacional de cada pool.
+    estado (numpy.array): Estado atual de cada pool (DESLIGADO, INICIANDO, LIGADO).
+    restante (numpy.array): Tempo restante do temporizador de cada pool
+        (inicialização ou ociosidade; np.inf se ligado com carga).
+    P (float): Consumo estático de energia.
+    P_prime (float): Consumo dinâmico de energia.
+    C (float): Capacidade computacional.
+    T (float): Intervalo de tempo.
+    cfg (dict): Custos de transição (POWER_STATES).
+
+    Retorna:
+    tuple: Energia total e tempo de carga à espera de inicialização,
+    ponderado pela carga e somado sobre os pools.
+    """
+    carregado = L > 0
+    P_ligado = P + P_prime * (L / C)
+    P_boot = cfg["boot_factor"] * P
+    energia = np.zeros(len(L))
+    espera = np.zeros(len(L))
+
+    ligado = estado == LIGADO
+    ocioso = np.where(np.isinf(restante), cfg["idle_timeout"], restante)
+    sem_carga = ligado & ~carregado
+    energia[ligado & carregado] = (P_ligado * T)[ligado & carregado]
+    energia[sem_carga] = np.where(ocioso < T, P * ocioso + cfg["shutdown_energy"],
+                                  P * T)[sem_carga]
+
+    iniciando = estado == INICIANDO
+    boot = np.minimum(restante, T)
+    energia[iniciando] = (P_boot * boot + np.where(carregado, P_ligado, P) * (T - boot))[iniciando]
+    espera[iniciando & carregado] = boot[iniciando & carregado]
+
+    ligar = (estado == DESLIGADO) & carregado
+    boot = min(cfg["wake_delay"], T)
+    energia[ligar] = (cfg["wake_energy"] + P_boot * boot + P_ligado * (T - boot))[ligar]
+    espera[ligar] = boot
+
+    return np.sum(energia), np.sum(espera * L)
+
+
+def update_pool_states(L, estado, restante, T, cfg=POWER_STATES):
+    """
+    Avança a máquina de estados dos pools por um intervalo T com a carga L.
+
+    Parâmetros:
+    L (numpy.array): Carga computacional de cada pool no intervalo.
+    estado (numpy.array): Estado atual de cada pool.
+    restante (numpy.array): Tempo restante do temporizador de cada pool.
+    T (float): Intervalo de tempo.
+    cfg (dict): Custos de transição (POWER_STATES).
+
+    Retorna:
+    tuple: Novos arrays (estado, restante).
+    """
+    estado = estado.copy()
+    restante = restante.astype(float)
+    for i in range(len(L)):
+        if L[i] > 0:
+            if estado[i] == DESLIGADO:
+                estado[i], restante[i] = INICIANDO, cfg["wake_delay"]
+            elif estado[i] == LIGADO:
+                restante[i] = np.inf
+        elif estado[i] == LIGADO and np.isinf(restante[i]):
+            restante[i] = cfg["idle_timeout"]
+        if estado[i] == INICIANDO or (estado[i] == LIGADO and not np.isinf(restante[i])):
+            restante[i] -= T
+            if restante[i] <= 0 and estado[i] == INICIANDO:
+                estado[i] = LIGADO
+                restante[i] = np.inf if L[i] > 0 else cfg["idle_timeout"] + restante[i]
+            elif restante[i] <= 0:
+                estado[i], restante[i] = DESLIGADO, 0.0
+    return estado, restante
+
 def calculate_energy_total(A_t, B_t, S_t, 
                            L_epm, L_cpm, 
                            P_epm, P_prime_epm, C_epm, 
                            P_cpm, P_prime_cpm, C_cpm, 
-                           V_du, V_cu, alpha, beta, T):
+                           V_du, V_cu, alpha, beta, T,
+                           states_epm=None, states_cpm=None, overload_penalty=1000.0):
     """
     Função para calcular o consumo total de energia no intervalo de tempo t.
 
@@ -27,6 +120,11 @@ def calculate_energy_total(A_t, B_t, S_t,
     alpha (float): Coeficiente de migração para tráfego.
     beta (float): Coeficiente fixo de energia de migração.
     T (float): Intervalo de tempo para cálculo.
+    states_epm (tuple): (estado, restante) dos EPMs; None desliga a potência
+        estática instantaneamente quando L == 0.
+    states_cpm (tuple): (estado, restante) dos CPMs, como states_epm.
+    overload_penalty (float): Penalidade por unidade de carga e segundo à
+        espera da inicialização de um pool.
 
     Retorna:
     float: Energia total calculada.
@@ -36,14 +134,24 @@ def calculate_energy_total(A_t, B_t, S_t,
         A_t = A_t[:, np.newaxis]
 
     # Energia relacionada ao processamento nos EPMs
-    E_processing_epm = np.sum(
-        (L_epm > 0) * P_epm + P_prime_epm * (L_epm / C_epm)
-    ) * T
+    if states_epm is None:
+        E_processing_epm = np.sum(
+            (L_epm > 0) * P_epm + P_prime_epm * (L_epm / C_epm)
+        ) * T
+    else:
+        E_processing_epm, espera = pool_states_energy(L_epm, *states_epm, P_epm,
+                                                      P_prime_epm, C_epm, T)
+        E_processing_epm += overload_penalty * espera
 
     # Energia relacionada ao processamento nos CPMs
-    E_processing_cpm = np.sum(
-        (L_cpm > 0) * P_cpm + P_prime_cpm * (L_cpm / C_cpm)
-    ) * T
+    if states_cpm is None:
+        E_processing_cpm = np.sum(
+            (L_cpm > 0) * P_cpm + P_prime_cpm * (L_cpm / C_cpm)
+        ) * T
+    else:
+        E_processing_cpm, espera = pool_states_energy(L_cpm, *states_cpm, P_cpm,
+                                                      P_prime_cpm, C_cpm, T)
+        E_processing_cpm += overload_penalty * espera
 
     # Energia relacionada à migração nos EPMs
     if A_t.shape[0] > 1:
@@ -68,7 +176,8 @@ def calculate_energy_total(A_t, B_t, S_t,
 
 def flower_pollination_algorithm(max_generations, population_size, bounds, 
                                  L_epm, L_cpm, P_epm, P_prime_epm, C_epm, 
-                                 P_cpm, P_prime_cpm, C_cpm, V_du, V_cu, alpha, beta, T):
+                                 P_cpm, P_prime_cpm, C_cpm, V_du, V_cu, alpha, beta, T,
+                                 states_epm=None, states_cpm=None):
     """
     Implementação do algoritmo de polinização por flores (FPA) para otimização.
 
@@ -76,6 +185,8 @@ def flower_pollination_algorithm(max_generations, population_size, bounds,
     max_generations (int): Número máximo de gerações.
     population_size (int): Tamanho da população.
     bounds (list of tuple): Limites das variáveis de decisão.
+    states_epm, states_cpm (tuple): Estados de energia dos pools, ver
+        calculate_energy_total.
 
     Retorna:
     tuple: Melhor solução encontrada e seu valor objetivo.
@@ -91,7 +202,8 @@ def flower_pollination_algorithm(max_generations, population_size, bounds,
                                       L_epm, L_cpm, 
                                       P_epm, P_prime_epm, C_epm, 
                                       P_cpm, P_prime_cpm, C_cpm, 
-                                      V_du, V_cu, alpha, beta, T) for A_t in population]
+                                      V_du, V_cu, alpha, beta, T,
+                                      states_epm, states_cpm) for A_t in population]
 
     best_solution = population[np.argmin(fitness)]
     best_fitness = min(fitness)
@@ -118,7 +230,8 @@ def flower_pollination_algorithm(max_generations, population_size, bounds,
                                           L_epm, L_cpm, 
                                           P_epm, P_prime_epm, C_epm, 
                                           P_cpm, P_prime_cpm, C_cpm, 
-                                          V_du, V_cu, alpha, beta, T) for A_t in population]
+                                          V_du, V_cu, alpha, beta, T,
+                                          states_epm, states_cpm) for A_t in population]
 
         current_best = min(fitness)
         if current_best < best_fitness:
@@ -157,11 +270,22 @@ V_cu = np.array([15, 20])  # Volume de dados migrados pelas CUs
 alpha = 0.5  # Coeficiente de migração
 beta = 10  # Coeficiente fixo de migração
 T = 1  # Intervalo de tempo
+# Todos os pools começam ligados e com carga
+states_epm = (np.full(len(L_epm), LIGADO), np.full(len(L_epm), np.inf))
+states_cpm = (np.full(len(L_cpm), LIGADO), np.full(len(L_cpm), np.inf))
 
 # Executar o algoritmo
 best_solution, best_fitness = flower_pollination_algorithm(100, 20, bounds, 
                                                            L_epm, L_cpm, P_epm, P_prime_epm, C_epm, 
-                                                           P_cpm, P_prime_cpm, C_cpm, V_du, V_cu, alpha, beta, T)
+                                                           P_cpm, P_prime_cpm, C_cpm, V_du, V_cu, alpha, beta, T,
+                                                           states_epm, states_cpm)
 
 print("Melhor solução encontrada:", best_solution)
 print("Melhor valor objetivo:", best_fitness)
+
+# Estados dos pools no início do próximo intervalo, a partir dos quais a
+# próxima otimização seria avaliada
+states_epm = update_pool_states(L_epm, *states_epm, T)
+states_cpm = update_pool_states(L_cpm, *states_cpm, T)
+print("Estados dos EPMs no próximo intervalo:", states_epm[0], "restante:", states_epm[1])
+print("Estados dos CPMs no próximo intervalo:", states_cpm[0], "restante:", states_cpm[1])
@@ -0,0 +1,143 @@
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+
+# Cenários de tamanho fixo (semente fixa) usados como referência de desempenho
+PRESETS = {
+    "small": {"mmWaveEnbs": 4, "uesPerEnb": 3, "simTime": 5.0, "dlInterval": 0.001,
+              "optimizer": "true"},
+    "medium": {"mmWaveEnbs": 16, "uesPerEnb": 5, "simTime": 5.0, "dlInterval": 0.001,
+               "optimizer": "true"},
+    "large": {"mmWaveEnbs": 36, "uesPerEnb": 10, "simTime": 5.0, "dlInterval": 0.001,
+              "optimizer": "true"},
+}
+
+RNG_SEED = 1
+RNG_RUN = 1
+
+# Métricas comparadas e o sentido em que uma variação é uma regressão
+# (+1: maior é pior, -1: menor é pior, 0: qualquer diferença é suspeita)
+METRICS = {
+    "wall_time_s": +1,
+    "peak_rss_kb": +1,
+    "events_per_s": -1,
+    "events_executed": 0,
+}
+
+DEFAULT_RUNNER = './ns3 run --no-build "ns3_oran_new_model_energy {args}"'
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "benchmarks", "baselines.json")
+
+
+def run_preset(name, runner, ns3_dir):
+    """
+    Executa um cenário de referência e retorna o relatório JSON do ns-3.
+
+    Parâmetros:
+    name (str): Nome do cenário em PRESETS.
+    runner (str): Comando de execução, com {args} no lugar dos argumentos.
+    ns3_dir (str): Diretório raiz do ns-3 onde o comando é executado.
+
+    Retorna:
+    dict: Tempo de parede, pico de RSS, eventos executados e eventos/s.
+    """
+    fd, report = tempfile.mkstemp(prefix="bench-" + name + "-", suffix=".json")
+    os.close(fd)
+    args = ["--benchmark=" + report,
+            "--RngSeed=%d" % RNG_SEED, "--RngRun=%d" % RNG_RUN]
+    args += ["--%s=%s" % (k, v) for k, v in PRESETS[name].items()]
+    command = runner.format(args=" ".join(args))
+    try:
+        subprocess.run(shlex.split(command), cwd=ns3_dir, check=True,
+                       stdout=subprocess.DEVNULL)
+        with open(report) as f:
+            return json.load(f)
+    finally:
+        os.remove(report)
+
+
+def compare(results, baselines, tolerance):
+    """
+    Compara resultados com as referências armazenadas.
+
+    Parâmetros:
+    results (dict): Resultados por cenário.
+    baselines (dict): Referências por cenário.
+    tolerance (float): Variação relativa aceita (0.1 = 10%).
+
+    Retorna:
+    list: Mensagens de regressão; vazia se nenhuma métrica regrediu.
+    """
+    regressions = []
+    for name, result in results.items():
+        if name not in baselines:
+            print("%-8s sem referência armazenada" % name)
+            continue
+        for metric, direction in METRICS.items():
+            ref = baselines[name][metric]
+            value = result[metric]
+            change = (value - ref) / ref if ref else 0.0
+            if direction == 0:
+                bad = abs(change) > 0
+            else:
+                bad = direction * change > tolerance
+            status = "REGRESSÃO" if bad else "ok"
+            print("%-8s %-16s ref=%-14.6g atual=%-14.6g %+7.1f%%  %s"
+                  % (name, metric, ref, value, 100 * change, status))
+            if bad:
+                regressions.append("%s: %s %+.1f%%" % (name, metric, 100 * change))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Suíte de regressão de desempenho do cenário O-RAN")
+    parser.add_argument("mode", choices=["run", "compare", "update"],
+                        help="run: só mede; compare: mede e compara com as "
+                             "referências; update: mede e grava as referências")
+    parser.add_argument("--presets", default="small,medium,large")
+    parser.add_argument("--runner", default=DEFAULT_RUNNER)
+    parser.add_argument("--ns3-dir", default=".")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--tolerance", type=float, default=0.10)
+    parser.add_argument("--output", help="Grava os resultados medidos neste JSON")
+    opts = parser.parse_args()
+
+    results = {}
+    for name in opts.presets.split(","):
+        results[name] = run_preset(name, opts.runner, opts.ns3_dir)
+        r = results[name]
+        print("%-8s %.2f s, %d kB, %d eventos, %.0f eventos/s"
+              % (name, r["wall_time_s"], r["peak_rss_kb"],
+                 r["events_executed"], r["events_per_s"]))
+
+    if opts.output:
+        with open(opts.output, "w") as f:
+            json.dump(results, f, indent=2)
+
+    if opts.mode == "update":
+        baselines = {}
+        if os.path.exists(opts.baseline):
+            with open(opts.baseline) as f:
+                baselines = json.load(f)
+        baselines.update(results)
+        os.makedirs(os.path.dirname(os.path.abspath(opts.baseline)), exist_ok=True)
+        with open(opts.baseline, "w") as f:
+            json.dump(baselines, f, indent=2)
+    elif opts.mode == "compare":
+        with open(opts.baseline) as f:
+            baselines = json.load(f)
+        regressions = compare(results, baselines, opts.tolerance)
+        if regressions:
+            print("Regressões acima de %.0f%%:" % (100 * opts.tolerance))
+            for r in regressions:
+                print("  " + r)
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+import argparse
+import csv
+import struct
+import sys
+import xml.etree.ElementTree as ET
+from array import array
+
+# Formato do arquivo de trajetórias: ver TrajectoryFormat em oran-trajectory-mobility.h
+MAGIC = b"ORANTRJ1"
+HEADER = struct.Struct("<8sII")
+TRACK = struct.Struct("<QQ")
+WAYPOINT = struct.Struct("<dff")
+
+
+def read_fcd(path, kinds):
+    """
+    Lê as posições de um arquivo FCD do SUMO (--fcd-output) sem carregar a
+    árvore XML inteira.
+
+    Parâmetros:
+    path (str): Arquivo FCD.
+    kinds (set): Elementos aceitos dentro de cada timestep ("vehicle", "person").
+
+    Retorna:
+    generator: Tuplas (id, tempo, x, y).
+    """
+    time = 0.0
+    for event, elem in ET.iterparse(path, events=("start", "end")):
+        if event == "start" and elem.tag == "timestep":
+            time = float(elem.get("time"))
+        elif event == "end" and elem.tag in kinds:
+            yield elem.get("id"), time, float(elem.get("x")), float(elem.get("y"))
+        elif event == "end" and elem.tag == "timestep":
+            elem.clear()
+
+
+def read_csv(path):
+    """
+    Lê as posições de um CSV com as colunas id, time, x, y.
+
+    Retorna:
+    generator: Tuplas (id, tempo, x, y).
+    """
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            yield row["id"], float(row["time"]), float(row["x"]), float(row["y"])
+
+
+def collect_tracks(points, max_tracks=None):
+    """
+    Agrupa as posições por UE em vetores compactos.
+
+    Parâmetros:
+    points (iterable): Tuplas (id, tempo, x, y).
+    max_tracks (int): Número máximo de trilhas, os primeiros ids vistos.
+
+    Retorna:
+    tuple: (lista de ids, dict id -> (tempos, xs, ys)) com os vetores ordenados no tempo.
+    """
+    order = []
+    tracks = {}
+    for uid, t, x, y in points:
+        track = tracks.get(uid)
+        if track is None:
+            if max_tracks is not None and len(order) >= max_tracks:
+                continue
+            track = tracks[uid] = (array("d"), array("f"), array("f"))
+            order.append(uid)
+        track[0].append(t)
+        track[1].append(x)
+        track[2].append(y)
+    for uid in order:
+        ts, xs, ys = tracks[uid]
+        if any(ts[i] > ts[i + 1] for i in range(len(ts) - 1)):
+            idx = sorted(range(len(ts)), key=ts.__getitem__)
+            tracks[uid] = (array("d", (ts[i] for i in idx)), array("f", (xs[i] for i in idx)),
+                           array("f", (ys[i] for i in idx)))
+    return order, tracks
+
+
+def write_trajectories(path, order, tracks, chunk=4096, shift=(0.0, 0.0)):
+    """
+    Grava as trilhas no formato binário lido por TrajectoryFile.
+
+    Parâmetros:
+    path (str): Arquivo de saída.
+    order (list): Ids na ordem das trilhas.
+    tracks (dict): id -> (tempos, xs, ys).
+    chunk (int): Pontos de cada pré-carregamento do simulador.
+    shift (tuple): Deslocamento (dx, dy) somado a todas as posições.
+
+    Retorna:
+    int: Número total de pontos gravados.
+    """
+    offset = HEADER.size + TRACK.size * len(order)
+    total = 0
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, len(order), chunk))
+        for uid in order:
+            n = len(tracks[uid][0])
+            f.write(TRACK.pack(offset, n))
+            offset += n * WAYPOINT.size
+        for uid in order:
+            ts, xs, ys = tracks[uid]
+            buf = bytearray(len(ts) * WAYPOINT.size)
+            for i in range(len(ts)):
+                WAYPOINT.pack_into(buf, i * WAYPOINT.size, ts[i], xs[i] + shift[0],
+                                   ys[i] + shift[1])
+            f.write(buf)
+            total += len(ts)
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Converte trajetórias FCD do SUMO (ou CSV id,time,x,y) para o arquivo "
+                    "binário de --trajectoryFile")
+    parser.add_argument("input", help="Arquivo FCD (.xml) ou CSV (.csv)")
+    parser.add_argument("output")
+    parser.add_argument("--kinds", default="vehicle,person",
+                        help="Elementos FCD convertidos, separados por vírgula")
+    parser.add_argument("--max-tracks", type=int, default=None)
+    parser.add_argument("--chunk", type=int, default=4096,
+                        help="Pontos por bloco pré-carregado pelo simulador")
+    parser.add_argument("--origin", action="store_true",
+                        help="Desloca as posições para que o menor x e y fiquem em 0")
+    args = parser.parse_args()
+
+    if args.input.endswith(".csv"):
+        points = read_csv(args.input)
+    else:
+        points = read_fcd(args.input, set(args.kinds.split(",")))
+    order, tracks = collect_tracks(points, args.max_tracks)
+    if not order:
+        sys.exit("Nenhuma posição em " + args.input)
+    shift = (0.0, 0.0)
+    if args.origin:
+        shift = (-min(min(tracks[u][1]) for u in order), -min(min(tracks[u][2]) for u in order))
+    total = write_trajectories(args.output, order, tracks, args.chunk, shift)
+    print("%d trilhas, %d pontos em %s" % (len(order), total, args.output))
+
+
+if __name__ == "__main__":
+    main()
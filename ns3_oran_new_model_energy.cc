@@ -5,10 +5,36 @@
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-helper.h"
 #include <ns3/lte-ue-net-device.h>
+#include <ns3/lte-ue-rrc.h>
 #include "ns3/mmwave-helper.h"
 #include "ns3/epc-helper.h"
 #include "ns3/mmwave-point-to-point-epc-helper.h"
 #include "ns3/lte-helper.h"
+#include "oran-downsampler.h"
+#include "oran-drx.h"
+#include "oran-energy-kpi.h"
+#include "oran-energy-orchestrator.h"
+#include "oran-idle-ue.h"
+#include "oran-mobility-predictor.h"
+#include "oran-partial-sleep.h"
+#include "oran-perf-counters.h"
+#include "oran-radio-power-model.h"
+#include "oran-realtime-monitor.h"
+#include "oran-results-store.h"
+#include "oran-timer-wheel.h"
+#include "oran-trace-timeline.h"
+#include "oran-trace-writer.h"
+#include "oran-trajectory-mobility.h"
+#include "oran-ue-pool.h"
+#include "oran-ue-energy.h"
+#include "oran-what-if.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/resource.h>
 
 using namespace ns3;
 using namespace mmwave;
@@ -20,11 +46,35 @@ using namespace mmwave;
 
 NS_LOG_COMPONENT_DEFINE ("ScenarioZero");
 
+/**
+ * Marks a scenario phase for both the hardware counters and the timeline.
+ */
+class ScenarioPhase
+{
+public:
+  ScenarioPhase (const char *name, const char *category)
+    : m_perf (name),
+      m_span (name, category)
+  {
+  }
+
+  void
+  Stop (void)
+  {
+    m_span.Stop ();
+    m_perf.Stop ();
+  }
+
+private:
+  PerfCounterScope m_perf;
+  TimelineSpan m_span;
+};
+
 void
 PrintGnuplottableUeListToFile (std::string filename)
 {
-  std::ofstream outFile;
-  outFile.open (filename.c_str (), std::ios_base::out | std::ios_base::trunc);
+  ScenarioPhase phase ("trace.ueList", "io");
+  TraceFile outFile (filename);
   if (!outFile.is_open ())
     {
       NS_LOG_ERROR ("Can't open file " << filename);
@@ -70,8 +120,8 @@ PrintGnuplottableUeListToFile (std::string filename)
 void
 PrintGnuplottableEnbListToFile (std::string filename)
 {
-  std::ofstream outFile;
-  outFile.open (filename.c_str (), std::ios_base::out | std::ios_base::trunc);
+  ScenarioPhase phase ("trace.enbList", "io");
+  TraceFile outFile (filename);
   if (!outFile.is_open ())
     {
       NS_LOG_ERROR ("Can't open file " << filename);
@@ -124,9 +174,975 @@ CalculateEnergyConsumption (Ptr<Node> node, double &energyProcessing, double &en
   energyMigration = (alpha * dataVolume + beta) * T;
 }
 
+/**
+ * State shared by the periodic RIC and energy sampling events.
+ */
+struct ScenarioState : public SimpleRefCount<ScenarioState>
+{
+  NodeContainer ueNodes;
+  NetDeviceContainer ueDevs;
+  std::map<uint16_t, uint32_t> duIndex; //!< mmWave cell ID to DU/CU index
+  Ptr<EnergyOrchestrator> orchestrator; //!< null when the optimizer is disabled
+  std::unique_ptr<TraceFile> energyTrace; //!< null when not requested
+  std::unique_ptr<TraceFile> mobilityTrace; //!< null when not requested
+  std::unique_ptr<TraceFile> kpiTrace; //!< null when not requested
+  std::vector<Ptr<PacketSink>> sinks; //!< downlink sink of every UE, empty without traffic
+  std::vector<uint64_t> lastRx; //!< sink byte counters at the previous energy sample
+  double lastEnergySample = 0.0; //!< time of the previous energy sample (s)
+  std::vector<uint16_t> cellIds; //!< mmWave cell ID of every DU/CU index
+  EnergyKpiTracker kpi;
+  RadioPowerModel mmWaveRadio {RadioSiteConfig::MmWaveSmallCell ()};
+  RadioPowerModel lteRadio {RadioSiteConfig::LteMacro ()};
+  uint32_t nLteCells = 0;
+  std::unique_ptr<PartialSleepController> sleep; //!< null when partial sleep is disabled
+  std::vector<double> radioEnergy; //!< mmWave radio energy since the previous sample (J)
+  std::vector<uint64_t> radioLastRx; //!< sink byte counters at the previous radio step
+  double radioLastStep = 0.0; //!< time of the previous radio step without partial sleep (s)
+  std::vector<uint64_t> sleepLastRx; //!< sink byte counters at the previous control step
+  double sleepLastStep = 0.0; //!< time of the previous control step (s)
+  double sleepControlInterval = 0.0; //!< (s)
+  bool sleepSuspended = false; //!< no control step scheduled while every cell is parked
+  std::vector<Ptr<MmWaveEnbPhy>> enbPhys; //!< PHY of every DU/CU index
+  std::vector<double> enbTxPower; //!< full-state TX power of every DU/CU index (dBm)
+  UeEnergyModel ueEnergy; //!< UE devices, indexed as ueNodes
+  std::vector<double> lastUeEnergy; //!< energy of every UE at the previous sampling tick
+  std::vector<double> ueCharged; //!< energy of every UE counted so far
+  std::unique_ptr<DrxScheduler> drx; //!< null when DRX is disabled
+  std::map<uint64_t, uint32_t> ueIndex; //!< IMSI to UE index
+  std::vector<uint8_t> bearerUp; //!< whether the data radio bearer of every UE is set up
+  Ptr<Node> remoteHost;
+  std::vector<UdpClientHelper> dlClients; //!< client of every UE, installed once its bearer is up
+  std::vector<Ptr<Socket>> dlSockets; //!< remote host socket towards every UE, when paced here
+  std::vector<double> drxPending; //!< downlink packets of every UE held until its on-duration
+  uint64_t drxPackets = 0; //!< packets delivered in on-duration bursts
+  double dlPacketInterval = 0.0;
+  uint32_t dlPacketSize = 0;
+  std::unique_ptr<IdleUePopulation> idle; //!< null when every UE has a full device
+  UeDevicePool pool; //!< UE devices lent to the sessions of idle records
+  std::vector<double> sessionEnd; //!< end of the session on every UE device (s)
+  std::vector<uint32_t> due; //!< scratch of IdlePopulationTick
+  std::vector<double> cellX; //!< position of every DU/CU index
+  std::vector<double> cellY;
+  std::unique_ptr<MobilityPredictor> predictor; //!< null when migrations are not proactive
+  double predictionHorizon = 0.0; //!< (s)
+  std::vector<double> ueX; //!< UE positions at the last prediction
+  std::vector<double> ueY;
+  std::vector<int32_t> predictedDu; //!< DU/CU index predicted to serve every UE, or -1
+  std::vector<int32_t> nearestDu; //!< DU/CU index closest to every UE now, or -1
+  std::vector<int32_t> lastPredictedDu; //!< predictedDu at the previous prediction
+  uint64_t predictedChanges = 0; //!< cell changes predicted so far
+  std::unique_ptr<RealtimeMonitor> realtime; //!< null unless emulating in real time
+  uint32_t fpaGenerations = 0; //!< FPA generations at full fidelity
+  std::unique_ptr<TimerWheel> timers; //!< null when protocol timers are simulator events
+  std::unique_ptr<WhatIfLookahead> whatIf; //!< null unless the RIC loop looks ahead
+  double lookaheadHorizon = 0.0; //!< (s)
+  WhatIfOutcome whatIfStart; //!< totals when a what-if child took its candidate
+  uint64_t whatIfDecisions = 0;
+  uint64_t whatIfOverrides = 0; //!< decisions other than the FPA's best placement
+  double alpha = 0.5;
+  double beta = 10.0;
+  double T = 1.0;
+  // Computational load of a DU/CU: a base load plus a share per attached UE
+  double duBaseLoad = 10.0;
+  double duLoadPerUe = 5.0;
+  double cuBaseLoad = 5.0;
+  double cuLoadPerUe = 2.0;
+  double contextPerUe = 1.0; //!< data migrated per attached UE when a DU/CU moves
+  // Totals over the run, reported to the results store
+  double totalPoolEnergy = 0.0;
+  double totalUeProcessing = 0.0;
+  double totalUeMigration = 0.0;
+  double totalRadioEnergy = 0.0;
+  double totalUeDeviceEnergy = 0.0;
+  double lastFitness = NAN;
+  std::vector<StreamingDownsampler> cellPower; //!< per DU, empty when not plotted
+};
+
+/**
+ * Per-DU/CU inputs of the orchestrator, rebuilt at every interval in the
+ * orchestrator's scratch arena.
+ */
+struct CellLoads
+{
+  explicit CellLoads (std::pmr::memory_resource *mr)
+    : du (mr),
+      cu (mr),
+      vDu (mr),
+      vCu (mr)
+  {
+  }
+
+  std::pmr::vector<double> du;
+  std::pmr::vector<double> cu;
+  std::pmr::vector<double> vDu;
+  std::pmr::vector<double> vCu;
+};
+
+/**
+ * \return the DU/CU index of the mmWave cell serving UE u, or -1
+ */
+int32_t
+GetServingDu (Ptr<ScenarioState> state, uint32_t u)
+{
+  Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (state->ueDevs.Get (u));
+  if (!mcUeDev || !mcUeDev->GetMmWaveTargetEnb ())
+    {
+      return -1;
+    }
+  auto it = state->duIndex.find (mcUeDev->GetMmWaveTargetEnb ()->GetCellId ());
+  return it == state->duIndex.end () ? -1 : static_cast<int32_t> (it->second);
+}
+
+/**
+ * Add the downlink bits delivered since lastRx to the UEs' serving cells,
+ * and advance lastRx.
+ * \param activeUes set to the number of UEs that received data
+ * \return the bits delivered to all UEs
+ */
+double
+CollectCellBits (Ptr<ScenarioState> state, std::vector<uint64_t> &lastRx,
+                 std::vector<double> &cellBits, uint32_t &activeUes)
+{
+  double networkBits = 0.0;
+  activeUes = 0;
+  for (uint32_t u = 0; u < state->sinks.size (); ++u)
+    {
+      uint64_t rx = state->sinks[u]->GetTotalRx ();
+      double bits = 8.0 * (rx - lastRx[u]);
+      lastRx[u] = rx;
+      if (bits > 0)
+        {
+          networkBits += bits;
+          activeUes++;
+          int32_t du = GetServingDu (state, u);
+          if (du >= 0)
+            {
+              cellBits[du] += bits;
+            }
+        }
+    }
+  return networkBits;
+}
+
+/**
+ * Feed the UE positions to the predictor and predict the DU/CU index that
+ * will serve every UE after the prediction horizon.  The predictor only
+ * knows distances, so a prediction is compared with the cell closest to
+ * the UE now rather than with its serving cell, which the radio picks: a
+ * UE is predicted to change cells when the two differ.
+ */
+void
+PredictServingCells (Ptr<ScenarioState> state)
+{
+  uint32_t nUes = state->ueNodes.GetN ();
+  for (uint32_t u = 0; u < nUes; ++u)
+    {
+      Vector pos = state->ueNodes.Get (u)->GetObject<MobilityModel> ()->GetPosition ();
+      state->ueX[u] = pos.x;
+      state->ueY[u] = pos.y;
+    }
+  state->predictor->Update (state->ueX.data (), state->ueY.data (),
+                            Simulator::Now ().GetSeconds ());
+  state->predictor->PredictCells (state->predictionHorizon, state->cellX.data (),
+                                  state->cellY.data (), state->cellX.size (),
+                                  state->predictedDu.data ());
+  state->predictor->PredictCells (0.0, state->cellX.data (), state->cellY.data (),
+                                  state->cellX.size (), state->nearestDu.data ());
+  for (uint32_t u = 0; u < nUes; ++u)
+    {
+      // Count every predicted move once, not at every interval until it happens
+      int32_t du = state->predictedDu[u];
+      state->predictedChanges += du != state->nearestDu[u] && du != state->lastPredictedDu[u];
+      state->lastPredictedDu[u] = du;
+    }
+}
+
+/**
+ * Build the DU/CU loads and migration volumes of the interval.  With
+ * predicted set, the load of a UE predicted to change cells is counted at
+ * the DU/CU predicted to serve it while its context still counts where it
+ * is served now, so the optimizer places DUs/CUs for where UEs are
+ * heading and moves them before the context they carry grows.
+ */
+void
+CollectCellLoads (Ptr<ScenarioState> state, CellLoads &loads, bool predicted = false)
+{
+  size_t nCells = state->duIndex.size ();
+  loads.du.assign (nCells, state->duBaseLoad);
+  loads.cu.assign (nCells, state->cuBaseLoad);
+  loads.vDu.assign (nCells, 0.0);
+  loads.vCu.assign (nCells, 0.0);
+  for (uint32_t u = 0; u < state->ueDevs.GetN (); ++u)
+    {
+      int32_t du = GetServingDu (state, u);
+      if (du < 0)
+        {
+          continue;
+        }
+      int32_t target = du;
+      if (predicted && state->predictedDu[u] >= 0
+          && state->predictedDu[u] != state->nearestDu[u])
+        {
+          target = state->predictedDu[u];
+        }
+      loads.du[target] += state->duLoadPerUe;
+      loads.cu[target] += state->cuLoadPerUe;
+      loads.vDu[du] += state->contextPerUe;
+      loads.vCu[du] += state->contextPerUe;
+    }
+}
+
+/**
+ * \return network energy so far, as counted by the energy KPI (J)
+ */
+double
+GetNetworkEnergy (Ptr<ScenarioState> state)
+{
+  return state->totalRadioEnergy + state->totalPoolEnergy + state->totalUeProcessing
+         + state->totalUeMigration;
+}
+
+/**
+ * \return downlink bits delivered to all UEs so far
+ */
+double
+GetDeliveredBits (Ptr<ScenarioState> state)
+{
+  double bits = 0.0;
+  for (const Ptr<PacketSink> &sink : state->sinks)
+    {
+      bits += 8.0 * sink->GetTotalRx ();
+    }
+  return bits;
+}
+
+/**
+ * Integrate the mmWave radio energy of every cell since the previous step
+ * at the load of the traffic it carried meanwhile, as the partial-sleep
+ * controller does when it runs.
+ */
+void
+StepRadioEnergy (Ptr<ScenarioState> state)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  double dt = now - state->radioLastStep;
+  if (dt <= 0)
+    {
+      return;
+    }
+  state->radioLastStep = now;
+  std::vector<double> bits (state->cellIds.size (), 0.0);
+  uint32_t activeUes;
+  CollectCellBits (state, state->radioLastRx, bits, activeUes);
+  for (size_t i = 0; i < bits.size (); ++i)
+    {
+      double load = bits[i] / (dt * state->mmWaveRadio.GetConfig ().peakRate);
+      state->radioEnergy[i] += state->mmWaveRadio.GetPower (load) * dt;
+    }
+}
+
+void
+RadioEnergyTick (Ptr<ScenarioState> state, Time interval)
+{
+  StepRadioEnergy (state);
+  Simulator::Schedule (interval, &RadioEnergyTick, state, interval);
+}
+
+/**
+ * Account the energy and the traffic of the network since the previous
+ * sample.  Every event that reads the energy totals or changes the
+ * placement samples first, so an interval is charged to the placement
+ * that held during it whatever the order of the events due at its end.
+ */
+void
+SampleEnergy (Ptr<ScenarioState> state)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  double dt = now - state->lastEnergySample;
+  if (dt <= 0)
+    {
+      return;
+    }
+  state->lastEnergySample = now;
+  ScenarioPhase phase ("energy.tick", "energy");
+  double ueProcessing = 0.0;
+  double ueMigration = 0.0;
+  double poolProcessing = 0.0;
+  std::vector<double> cellBits (state->cellIds.size (), 0.0);
+  uint32_t activeUes = 0;
+  double networkBits = CollectCellBits (state, state->lastRx, cellBits, activeUes);
+  // Radio energy of every site, integrated over the control steps at the
+  // load of the traffic it carried, by the partial-sleep controller when it
+  // runs; the LTE macro cells only carry control traffic and run at idle power
+  std::vector<double> cellEnergy (state->cellIds.size ());
+  double radio = state->nLteCells * state->lteRadio.GetPower (0.0) * dt;
+  if (state->sleep)
+    {
+      state->sleep->TakeEnergy (cellEnergy.data (), now);
+    }
+  else
+    {
+      StepRadioEnergy (state);
+      std::copy (state->radioEnergy.begin (), state->radioEnergy.end (), cellEnergy.begin ());
+      std::fill (state->radioEnergy.begin (), state->radioEnergy.end (), 0.0);
+    }
+  for (size_t i = 0; i < cellEnergy.size (); ++i)
+    {
+      radio += cellEnergy[i];
+    }
+  state->ueEnergy.Update (now);
+  // UE device energy spent during this tick.  With an idle population, a
+  // device only stands for a UE while it hosts a session
+  double ueDeviceTick = 0.0;
+  for (uint32_t i = 0; i < state->ueNodes.GetN (); ++i)
+    {
+      Ptr<Node> ue = state->ueNodes.Get (i);
+      double energyProcessing;
+      double energyMigration;
+      CalculateEnergyConsumption (ue, energyProcessing, energyMigration, state->alpha,
+                                  state->beta, dt);
+      ueProcessing += energyProcessing;
+      ueMigration += energyMigration;
+      double energy = state->ueEnergy.GetEnergy (i);
+      if (!state->idle || state->pool.GetOwner (i) >= 0)
+        {
+          ueDeviceTick += energy - state->lastUeEnergy[i];
+          state->ueCharged[i] += energy - state->lastUeEnergy[i];
+        }
+      state->lastUeEnergy[i] = energy;
+
+      NS_LOG_INFO (now << "s UE " << i << ": Processing Energy = " << energyProcessing
+                       << " J, Migration Energy = " << energyMigration
+                       << " J, Device Energy = " << state->ueEnergy.GetEnergy (i)
+                       << " J, Battery Drain = " << 100 * state->ueEnergy.GetBatteryDrain (i)
+                       << " %");
+    }
+  if (state->idle)
+    {
+      ueDeviceTick +=
+          state->idle->GetNIdle () * state->ueEnergy.GetConfig ().idlePower * dt;
+    }
+  if (state->orchestrator)
+    {
+      Ptr<EnergyOrchestrator> orchestrator = state->orchestrator;
+      {
+        CellLoads loads (&orchestrator->GetArena ());
+        CollectCellLoads (state, loads);
+        const OrchestratorConfig &config = orchestrator->GetConfig ();
+        size_t nCells = loads.du.size ();
+        std::pmr::vector<double> epmEnergy (config.nEpm, &orchestrator->GetArena ());
+        std::pmr::vector<double> cpmEnergy (config.nCpm, &orchestrator->GetArena ());
+        std::pmr::vector<double> duEnergy (nCells, &orchestrator->GetArena ());
+        std::pmr::vector<double> cuEnergy (nCells, &orchestrator->GetArena ());
+        orchestrator->SplitEnergy (loads.du.data (), loads.cu.data (), dt, epmEnergy.data (),
+                                   cpmEnergy.data (), duEnergy.data (), cuEnergy.data ());
+        std::pmr::vector<double> epmBits (config.nEpm, 0.0, &orchestrator->GetArena ());
+        std::pmr::vector<double> cpmBits (config.nCpm, 0.0, &orchestrator->GetArena ());
+        for (size_t i = 0; i < nCells; ++i)
+          {
+            cellEnergy[i] += duEnergy[i] + cuEnergy[i];
+            // The bits of a cell not placed yet are no pool's work
+            uint32_t epm = orchestrator->GetDuPlacement ()[i];
+            uint32_t cpm = orchestrator->GetCuPlacement ()[i];
+            if (epm != EnergyOrchestrator::UNPLACED)
+              {
+                epmBits[epm] += cellBits[i];
+              }
+            if (cpm != EnergyOrchestrator::UNPLACED)
+              {
+                cpmBits[cpm] += cellBits[i];
+              }
+          }
+        for (uint32_t e = 0; e < config.nEpm; ++e)
+          {
+            state->kpi.Epm (e).Add (epmBits[e], epmEnergy[e]);
+            poolProcessing += epmEnergy[e];
+          }
+        for (uint32_t c = 0; c < config.nCpm; ++c)
+          {
+            state->kpi.Cpm (c).Add (cpmBits[c], cpmEnergy[c]);
+            poolProcessing += cpmEnergy[c];
+          }
+        for (size_t i = 0; i < state->cellPower.size (); ++i)
+          {
+            // Load-proportional EPM/CPM power attributable to the cell's DU and CU
+            double power = config.pPrimeEpm * loads.du[i] / config.cEpm
+                           + config.pPrimeCpm * loads.cu[i] / config.cCpm;
+            state->cellPower[i].Add (now, power);
+          }
+        NS_LOG_UNCOND (Simulator::Now ().GetSeconds ()
+                       << "s EPM/CPM Processing Energy = " << poolProcessing << " J");
+        const std::vector<MultiCoreServer> &epms = orchestrator->GetEpmServers ();
+        for (uint32_t e = 0; e < epms.size (); ++e)
+          {
+            NS_LOG_INFO (now << "s EPM " << e << ": " << epms[e].GetBusyCores () << " busy, "
+                             << epms[e].GetSleepingCores () << " sleeping cores");
+          }
+      }
+      orchestrator->GetArena ().Reset ();
+    }
+  for (size_t i = 0; i < cellEnergy.size (); ++i)
+    {
+      state->kpi.Cell (i).Add (cellBits[i], cellEnergy[i]);
+    }
+  state->totalPoolEnergy += poolProcessing;
+  state->totalRadioEnergy += radio;
+  state->totalUeDeviceEnergy += ueDeviceTick;
+  state->totalUeProcessing += ueProcessing;
+  state->totalUeMigration += ueMigration;
+  state->kpi.AddNetwork (networkBits, radio + poolProcessing + ueProcessing + ueMigration,
+                         activeUes);
+  if (state->kpiTrace)
+    {
+      state->kpiTrace->SetTime (now);
+      state->kpi.WriteInterval (*state->kpiTrace, now, state->cellIds);
+    }
+  if (state->energyTrace)
+    {
+      state->energyTrace->SetTime (now);
+      *state->energyTrace << now << "\t" << poolProcessing << "\t"
+                          << ueProcessing << "\t" << ueMigration << "\t" << radio << "\t"
+                          << ueDeviceTick << std::endl;
+    }
+}
+
+void
+EnergySamplingTick (Ptr<ScenarioState> state)
+{
+  SampleEnergy (state);
+  Simulator::Schedule (Seconds (state->T), &EnergySamplingTick, state);
+}
+
+/**
+ * End of the lookahead horizon of a what-if child.
+ */
+void
+WhatIfReport (Ptr<ScenarioState> state)
+{
+  SampleEnergy (state);
+  WhatIfOutcome outcome;
+  outcome.energy = GetNetworkEnergy (state) - state->whatIfStart.energy;
+  outcome.bits = GetDeliveredBits (state) - state->whatIfStart.bits;
+  state->whatIf->Report (outcome);
+}
+
+/**
+ * Simulate every placement kept by the last FPA search over the lookahead
+ * horizon in a forked child and apply the one with the best outcome.
+ *
+ * \return the applied candidate
+ */
+uint32_t
+WhatIfDecide (Ptr<ScenarioState> state, const CellLoads &loads)
+{
+  Ptr<EnergyOrchestrator> orchestrator = state->orchestrator;
+  uint32_t n = orchestrator->GetNCandidates ();
+  int32_t child = n > 1 ? state->whatIf->Fork (n) : -1;
+  if (child >= 0)
+    {
+      // Trace files belong to the parent and their writer thread is gone: drop them
+      // unflushed
+      state->energyTrace.release ();
+      state->kpiTrace.release ();
+      state->mobilityTrace.release ();
+      // Migrations of the candidate count as energy spent in its horizon
+      state->whatIfStart.energy =
+          GetNetworkEnergy (state) - orchestrator->Apply (child, loads.du.data (),
+                                                          loads.cu.data (), loads.vDu.data (),
+                                                          loads.vCu.data ());
+      state->whatIfStart.bits = GetDeliveredBits (state);
+      // The energy up to now is sampled already: the horizon covers the intervals from
+      // now on, the last one sampled by the report itself
+      Simulator::Schedule (Seconds (state->lookaheadHorizon), &WhatIfReport, state);
+      return child;
+    }
+  uint32_t best = n > 1 ? state->whatIf->GetBest () : 0;
+  orchestrator->Apply (best, loads.du.data (), loads.cu.data (), loads.vDu.data (),
+                       loads.vCu.data ());
+  state->whatIfDecisions++;
+  state->whatIfOverrides += best != 0;
+  return best;
+}
+
+void
+RicControlLoop (Ptr<ScenarioState> state)
+{
+  // The interval ending now was served by the placement about to be replaced
+  SampleEnergy (state);
+  ScenarioPhase loop ("ric.loop", "ric");
+  double due = Simulator::Now ().GetSeconds ();
+  Ptr<EnergyOrchestrator> orchestrator = state->orchestrator;
+  {
+    CellLoads loads (&orchestrator->GetArena ());
+    if (state->predictor)
+      {
+        PredictServingCells (state);
+      }
+    CollectCellLoads (state, loads, state->predictor != nullptr);
+    ScenarioPhase phase ("optimizer.fpa", "optimizer");
+    double fitness;
+    if (state->whatIf && !state->whatIf->IsChild ())
+      {
+        orchestrator->Search (loads.du.data (), loads.cu.data (), loads.vDu.data (),
+                              loads.vCu.data (), state->T);
+        phase.Stop ();
+        ScenarioPhase whatIf ("optimizer.whatif", "optimizer");
+        fitness = orchestrator->GetCandidateFitness (WhatIfDecide (state, loads));
+      }
+    else
+      {
+        // What-if children follow the FPA's best placement after their first decision
+        fitness = orchestrator->Optimize (loads.du.data (), loads.cu.data (), loads.vDu.data (),
+                                          loads.vCu.data (), state->T);
+        phase.Stop ();
+      }
+    state->lastFitness = fitness;
+    NS_LOG_UNCOND (Simulator::Now ().GetSeconds ()
+                   << "s FPA placement: fitness = " << fitness
+                   << " J, migrations so far = " << orchestrator->GetMigrations ());
+  }
+  orchestrator->GetArena ().Reset ();
+  if (state->realtime && state->realtime->EndLoop (due))
+    {
+      NS_LOG_UNCOND (due << "s RIC loop missed its deadline, lag = "
+                         << state->realtime->GetLag () << " s");
+    }
+  Simulator::Schedule (Seconds (state->T), &RicControlLoop, state);
+}
+
+/**
+ * Measure how far the simulation lags the wall clock and, while it lags
+ * too far, shorten the FPA search of the RIC loop to a quarter.
+ */
+void
+RealtimeLagTick (Ptr<ScenarioState> state, Time interval)
+{
+  bool degraded = state->realtime->IsDegraded ();
+  double lag = state->realtime->Sample (Simulator::Now ().GetSeconds ());
+  NS_LOG_UNCOND (Simulator::Now ().GetSeconds () << "s real-time lag = " << lag << " s");
+  if (state->orchestrator && degraded != state->realtime->IsDegraded ())
+    {
+      uint32_t generations = state->fpaGenerations;
+      if (state->realtime->IsDegraded ())
+        {
+          generations = std::max<uint32_t> (generations / 4, 1);
+        }
+      state->orchestrator->SetGenerations (generations);
+      NS_LOG_UNCOND (Simulator::Now ().GetSeconds ()
+                     << "s FPA generations set to " << generations);
+    }
+  Simulator::Schedule (interval, &RealtimeLagTick, state, interval);
+}
+
+/**
+ * Apply a partial-sleep state to a cell: muted antenna subarrays lose their
+ * share of the array gain, seen by the scheduler as a lower TX power.
+ */
+void
+ApplySleepState (Ptr<ScenarioState> state, uint32_t cell, uint32_t sleepState)
+{
+  const PartialSleepState &info = state->sleep->GetStateInfo (sleepState);
+  state->enbPhys[cell]->SetTxPower (state->enbTxPower[cell]
+                                    + 10 * std::log10 (info.antennaFraction));
+}
+
+/**
+ * Step the partial-sleep controller.  Once every cell is parked no further
+ * step is scheduled until downlink data shows up again (see
+ * ResumeSleepControl), and the steps not run are reported to the
+ * controller when stepping resumes.  Parked cells keep being charged by
+ * every energy tick meanwhile.  Only this controller step is skipped: the
+ * mmWave MAC/PHY of an idle cell still runs every slot.
+ */
+void
+SleepControlTick (Ptr<ScenarioState> state, Time interval)
+{
+  ScenarioPhase phase ("sleep.control", "energy");
+  double now = Simulator::Now ().GetSeconds ();
+  double skipped = now - state->sleepLastStep - interval.GetSeconds ();
+  if (skipped > 0.5 * interval.GetSeconds ())
+    {
+      state->sleep->SkipParked (skipped, std::llround (skipped / interval.GetSeconds ()));
+    }
+  state->sleepLastStep = now;
+  std::vector<double> rate (state->cellIds.size (), 0.0);
+  uint32_t activeUes;
+  CollectCellBits (state, state->sleepLastRx, rate, activeUes);
+  for (double &r : rate)
+    {
+      r /= interval.GetSeconds ();
+    }
+  state->sleep->Step (rate.data (), interval.GetSeconds ());
+  state->sleepSuspended = state->sleep->AllParked ();
+  if (!state->sleepSuspended)
+    {
+      Simulator::Schedule (interval, &SleepControlTick, state, interval);
+    }
+}
+
+/**
+ * Restart the partial-sleep control steps suspended while every cell was
+ * parked.
+ */
+void
+ResumeSleepControl (Ptr<ScenarioState> state)
+{
+  if (state->sleep && state->sleepSuspended)
+    {
+      state->sleepSuspended = false;
+      Time interval = Seconds (state->sleepControlInterval);
+      Simulator::Schedule (interval, &SleepControlTick, state, interval);
+    }
+}
+
+void
+UeRrcStateTrace (Ptr<ScenarioState> state, uint64_t imsi, uint16_t cellId, uint16_t rnti,
+                 LteUeRrc::State oldState, LteUeRrc::State newState)
+{
+  state->ueEnergy.NotifyConnected (imsi, newState >= LteUeRrc::CONNECTED_NORMALLY,
+                                   Simulator::Now ().GetSeconds ());
+}
+
+void
+UeDownlinkTbTrace (Ptr<ScenarioState> state, uint64_t imsi, uint64_t tbSize)
+{
+  state->ueEnergy.NotifyRx (imsi, Simulator::Now ().GetSeconds ());
+  ResumeSleepControl (state);
+}
+
+void
+UeUplinkTbTrace (Ptr<ScenarioState> state, uint64_t imsi, uint64_t tbSize)
+{
+  state->ueEnergy.NotifyTx (imsi, Simulator::Now ().GetSeconds ());
+}
+
+void
+UeHandoverTrace (Ptr<ScenarioState> state, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  state->ueEnergy.NotifyHandover (imsi, Simulator::Now ().GetSeconds ());
+}
+
+/**
+ * Start the downlink flow of a UE once RRC set up its data radio bearer.
+ * Later reconfigurations of a connected UE change nothing.
+ */
+void
+UeBearerTrace (Ptr<ScenarioState> state, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  auto it = state->ueIndex.find (imsi);
+  if (it == state->ueIndex.end () || state->bearerUp[it->second])
+    {
+      return;
+    }
+  uint32_t u = it->second;
+  state->bearerUp[u] = 1;
+  NS_LOG_INFO (Simulator::Now ().GetSeconds () << "s bearer of IMSI " << imsi << " up in cell "
+                                               << cellId);
+  if (!state->dlClients.empty ())
+    {
+      // Installed while running, the client starts right away
+      state->dlClients[u].Install (state->remoteHost);
+    }
+}
+
+/**
+ * Deliver the downlink packets the network held for a group of UEs while
+ * they slept, as one burst at the start of their on-duration.
+ */
+void
+DrxWake (Ptr<ScenarioState> state, const uint32_t *ues, uint32_t n)
+{
+  double perCycle = state->drx->GetConfig ().cycle / state->dlPacketInterval;
+  for (uint32_t k = 0; k < n; k++)
+    {
+      uint32_t u = ues[k];
+      if (!state->bearerUp[u] || (state->idle && state->pool.GetOwner (u) < 0))
+        {
+          state->drxPending[u] = 0.0;
+          continue;
+        }
+      state->drxPending[u] += perCycle;
+      uint32_t burst = static_cast<uint32_t> (state->drxPending[u]);
+      state->drxPending[u] -= burst;
+      for (uint32_t p = 0; p < burst; p++)
+        {
+          state->dlSockets[u]->Send (Create<Packet> (state->dlPacketSize));
+        }
+      state->drxPackets += burst;
+    }
+}
+
+/**
+ * Send one downlink packet to every UE device that hosts a session.
+ */
+void
+SessionTrafficTick (Ptr<ScenarioState> state)
+{
+  for (uint32_t u = 0; u < state->pool.GetN (); ++u)
+    {
+      if (state->bearerUp[u] && state->pool.GetOwner (u) >= 0)
+        {
+          state->dlSockets[u]->Send (Create<Packet> (state->dlPacketSize));
+        }
+    }
+  Simulator::Schedule (Seconds (state->dlPacketInterval), &SessionTrafficTick, state);
+}
+
+/**
+ * Move the idle UE records, return the devices of ended sessions to the
+ * idle population and page the records whose session starts onto free
+ * devices, placed where the record is.
+ */
+void
+IdlePopulationTick (Ptr<ScenarioState> state, Time interval)
+{
+  ScenarioPhase phase ("idle.tick", "scenario");
+  IdleUePopulation &idle = *state->idle;
+  double now = Simulator::Now ().GetSeconds ();
+  idle.Move (interval.GetSeconds ());
+  idle.UpdateCamping (state->cellX.data (), state->cellY.data (), state->cellX.size ());
+
+  for (uint32_t u = 0; u < state->pool.GetN (); ++u)
+    {
+      int32_t record = state->pool.GetOwner (u);
+      if (record >= 0 && state->sessionEnd[u] <= now)
+        {
+          Vector pos = state->ueNodes.Get (u)->GetObject<MobilityModel> ()->GetPosition ();
+          idle.Demote (record, pos.x, pos.y, now);
+          state->pool.Release (u);
+        }
+    }
+
+  idle.CollectDue (now, state->due);
+  for (uint32_t record : state->due)
+    {
+      uint32_t u;
+      if (!state->pool.Acquire (record, u))
+        {
+          idle.Block (record, now);
+          continue;
+        }
+      // Reassign the device: the record's position and a fresh downlink flow
+      state->ueNodes.Get (u)->GetObject<MobilityModel> ()->SetPosition (
+          Vector (idle.GetX (record), idle.GetY (record), 1.5));
+      if (state->drx)
+        {
+          state->drxPending[u] = 0.0;
+        }
+      state->sessionEnd[u] = idle.Promote (record, now);
+      NS_LOG_INFO (now << "s idle UE " << record << " paged in cell "
+                       << state->cellIds[idle.GetCampedCell (record)] << " onto UE device "
+                       << u);
+    }
+  Simulator::Schedule (interval, &IdlePopulationTick, state, interval);
+}
+
+void
+MobilityTraceTick (Ptr<ScenarioState> state, Time interval)
+{
+  if (!state->mobilityTrace)
+    {
+      // Dropped by a what-if child
+      return;
+    }
+  ScenarioPhase phase ("trace.mobility", "io");
+  TraceFile &out = *state->mobilityTrace;
+  double now = Simulator::Now ().GetSeconds ();
+  for (uint32_t u = 0; u < state->ueDevs.GetN (); ++u)
+    {
+      Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (state->ueDevs.Get (u));
+      Vector pos = state->ueNodes.Get (u)->GetObject<MobilityModel> ()->GetPosition ();
+      out.SetTime (now);
+      out << now << "\t" << mcUeDev->GetImsi () << "\t" << pos.x << "\t" << pos.y << "\n";
+    }
+  Simulator::Schedule (interval, &MobilityTraceTick, state, interval);
+}
+
+/**
+ * Open a trace file of the scenario.
+ * \return the file, or nullptr (after logging) if it cannot be opened
+ */
+std::unique_ptr<TraceFile>
+OpenTraceFile (std::string filename, bool compressed)
+{
+  std::unique_ptr<TraceFile> file (new TraceFile (filename, 1 << 20, compressed));
+  if (!file->is_open ())
+    {
+      NS_LOG_ERROR ("Can't open file " << filename);
+      file.reset ();
+    }
+  return file;
+}
+
+/**
+ * Write the performance figures of one run as a JSON object, for the
+ * regression comparison done by benchmark_scenarios.py.
+ */
+void
+WriteBenchmarkReport (std::string filename, uint32_t nMmWaveEnbNodes, uint32_t nUeNodes,
+                      double simTime, double wallTime, double runWallTime, uint64_t events)
+{
+  TraceFile outFile (filename);
+  if (!outFile.is_open ())
+    {
+      NS_LOG_ERROR ("Can't open file " << filename);
+      return;
+    }
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  outFile << "{\n"
+          << "  \"mmwave_enbs\": " << nMmWaveEnbNodes << ",\n"
+          << "  \"ues\": " << nUeNodes << ",\n"
+          << "  \"sim_time_s\": " << simTime << ",\n"
+          << "  \"wall_time_s\": " << wallTime << ",\n"
+          << "  \"run_wall_time_s\": " << runWallTime << ",\n"
+          << "  \"peak_rss_kb\": " << usage.ru_maxrss << ",\n"
+          << "  \"events_executed\": " << events << ",\n"
+          << "  \"events_per_s\": " << (runWallTime > 0 ? events / runWallTime : 0.0) << "\n"
+          << "}" << std::endl;
+}
+
+/**
+ * \return value in the shortest form that reads back exactly, "10" rather
+ * than the "10.000000" of std::to_string, so that a stored parameter
+ * matches the value a query names
+ */
+std::string
+FormatParam (double value)
+{
+  char text[32];
+  for (int precision = 1; precision <= 17; precision++)
+    {
+      std::snprintf (text, sizeof (text), "%.*g", precision, value);
+      if (std::strtod (text, nullptr) == value)
+        {
+          break;
+        }
+    }
+  return text;
+}
+
+/**
+ * Append the parameters and totals of this run to a sweep results store,
+ * queried with sweep_query.py.
+ */
+void
+AppendToResultsStore (std::string dir, const std::map<std::string, std::string> &params,
+                      Ptr<ScenarioState> state, uint64_t rxBytes, double simTime, double wallTime,
+                      uint64_t events)
+{
+  std::map<std::string, double> metrics;
+  metrics["pool_energy_j"] = state->totalPoolEnergy;
+  metrics["radio_energy_j"] = state->totalRadioEnergy;
+  metrics["ue_device_energy_j"] = state->totalUeDeviceEnergy;
+  double maxDrain = 0.0;
+  for (uint32_t i = 0; i < state->ueEnergy.GetN (); ++i)
+    {
+      maxDrain = std::max (maxDrain, state->ueCharged[i]);
+    }
+  maxDrain /= state->ueEnergy.GetConfig ().batteryCapacity;
+  metrics["ue_max_battery_drain"] = maxDrain;
+  if (state->sleep)
+    {
+      metrics["sleep_control_steps"] = state->sleep->GetControlSteps ();
+      metrics["sleep_parked_control_steps"] = state->sleep->GetParkedControlSteps ();
+    }
+  if (state->predictor)
+    {
+      metrics["predicted_cell_changes"] = state->predictedChanges;
+    }
+  if (state->idle)
+    {
+      metrics["idle_ue_pages"] = state->idle->GetPages ();
+      metrics["ue_pool_size"] = state->pool.GetN ();
+      metrics["ue_pool_hits"] = state->pool.GetHits ();
+      metrics["ue_pool_misses"] = state->pool.GetMisses ();
+      metrics["ue_pool_peak"] = state->pool.GetPeakInUse ();
+    }
+  if (state->timers)
+    {
+      metrics["timer_wheel_timers"] = state->timers->GetInserted ();
+      metrics["timer_wheel_events"] = state->timers->GetEvents ();
+      metrics["scheduler_events_removed"] = state->timers->GetEventsRemoved ();
+    }
+  if (state->whatIf)
+    {
+      metrics["whatif_decisions"] = state->whatIfDecisions;
+      metrics["whatif_overrides"] = state->whatIfOverrides;
+      metrics["whatif_failures"] = state->whatIf->GetFailures ();
+    }
+  if (state->realtime)
+    {
+      metrics["rt_max_lag_s"] = state->realtime->GetMaxLag ();
+      metrics["rt_mean_lag_s"] = state->realtime->GetMeanLag ();
+      metrics["ric_missed_deadlines"] = state->realtime->GetMissedDeadlines ();
+      metrics["rt_degradations"] = state->realtime->GetDegradations ();
+    }
+  if (state->drx)
+    {
+      metrics["drx_wake_events"] = state->drx->GetWakeEvents ();
+    }
+  metrics["ue_processing_energy_j"] = state->totalUeProcessing;
+  metrics["ue_migration_energy_j"] = state->totalUeMigration;
+  metrics["dl_rx_bytes"] = rxBytes;
+  metrics["dl_throughput_bps"] = simTime > 0 ? 8.0 * rxBytes / simTime : 0.0;
+  metrics["wall_time_s"] = wallTime;
+  metrics["events_executed"] = events;
+  metrics["network_bits_per_j"] = state->kpi.GetNetwork ().GetBitsPerJoule ();
+  metrics["energy_per_active_ue_j"] = state->kpi.GetEnergyPerActiveUe ();
+  if (state->orchestrator)
+    {
+      metrics["migrations"] = state->orchestrator->GetMigrations ();
+      const PoolPowerStateMachine *epm = state->orchestrator->GetEpmPowerStates ();
+      const PoolPowerStateMachine *cpm = state->orchestrator->GetCpmPowerStates ();
+      if (epm)
+        {
+          metrics["pool_wake_ups"] = epm->GetWakeUps () + cpm->GetWakeUps ();
+          metrics["pool_shutdowns"] = epm->GetShutdowns () + cpm->GetShutdowns ();
+        }
+      metrics["fpa_fitness_j"] = state->lastFitness;
+    }
+  if (!ResultsStore::Append (dir, params, RngSeedManager::GetSeed (), RngSeedManager::GetRun (),
+                             metrics))
+    {
+      NS_LOG_ERROR ("Can't append to results store " << dir << ": " << std::strerror (errno));
+    }
+}
+
+/**
+ * Write the downsampled FPA convergence and per-cell power series as
+ * gnuplot binary files (see StreamingDownsampler::Write) in dir.
+ */
+void
+WritePlotSeries (std::string dir, Ptr<ScenarioState> state)
+{
+  std::vector<std::string> files;
+  std::vector<const StreamingDownsampler *> series;
+  if (state->orchestrator)
+    {
+      files.push_back (dir + "/fpa-convergence.bin");
+      series.push_back (&state->orchestrator->GetConvergence ());
+    }
+  for (const auto &cell : state->duIndex)
+    {
+      files.push_back (dir + "/cell-" + std::to_string (cell.first) + "-power.bin");
+      series.push_back (&state->cellPower[cell.second]);
+    }
+  for (size_t i = 0; i < files.size (); ++i)
+    {
+      TraceFile file (files[i], 1 << 16);
+      if (!file.is_open () || !series[i]->Write (file))
+        {
+          NS_LOG_ERROR ("Can't write file " << files[i]);
+        }
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
+  auto wallStart = std::chrono::steady_clock::now ();
+
   LogComponentEnableAll (LOG_PREFIX_ALL);
   LogComponentEnable ("MmWaveEnbNetDevice", LOG_LEVEL_DEBUG);
 
@@ -135,10 +1151,226 @@ main (int argc, char *argv[])
   // The maximum Y coordinate of the scenario
   double maxYAxis = 4000;
 
+  // Sample hardware performance counters around setup phases and hot paths
+  bool perfCounters = false;
+  // Chrome trace-event timeline output, empty to disable
+  std::string timelineFile = "";
+  // Benchmark report output, empty to disable
+  std::string benchmarkFile = "";
+  // Per-tick energy trace output, empty to disable
+  std::string energyTraceFile = "";
+  // Per-tick energy-efficiency KPI trace output, empty to disable
+  std::string kpiTraceFile = "";
+  // Periodic UE position trace output, empty to disable
+  std::string mobilityTraceFile = "";
+  double mobilityTraceInterval = 0.1;
+  // Write the energy and mobility traces as indexed LZ-compressed chunks
+  bool compressTraces = false;
+  // Directory of the downsampled plot series, empty to disable
+  std::string plotDir = "";
+  uint32_t plotPoints = 1000;
+  // UE trajectory file written by fcd_to_trajectory.py, empty for random walks
+  std::string trajectoryFile = "";
+  // Sweep results store directory, empty to disable
+  std::string resultsStoreDir = "";
+
+  uint32_t nMmWaveEnbNodes = 4;
+  uint32_t nLteEnbNodes = 1;
+  uint32_t ues = 3;
+  double simTime = 10.0;
+  // Run under the real-time simulator, for external xApps
+  bool realtime = false;
+  // Deadline of the RIC loop after its due time, under real-time emulation
+  double ricDeadline = 0.1;
+  // Lag behind the wall clock that degrades fidelity, zero to never degrade
+  double maxLag = 0.0;
+  double lagSampleInterval = 0.1;
+  // Tick of the timing wheel running the protocol timers, zero for simulator events
+  double timerWheelTick = 0.0;
+  // FPA placements simulated by forked children at every RIC decision, 0 or 1 to disable
+  uint32_t lookahead = 0;
+  // What-if horizon in seconds, 0 for one RIC interval
+  double lookaheadHorizon = 0.0;
+  // Attach UEs over ideal RRC and zero-delay core signaling and start traffic at t = 0
+  bool idealAttach = false;
+  // Downlink UDP traffic per UE, zero to disable
+  double dlPacketInterval = 0.001;
+  uint32_t dlPacketSize = 1024;
+  // Place DUs/CUs on EPMs/CPMs with the flower pollination algorithm every interval
+  bool optimizer = true;
+  OrchestratorConfig orchestratorConfig;
+  // Place DUs/CUs for the serving cells predicted this far ahead (s), zero to disable
+  double predictionHorizon = 0.0;
+  // Load levels of the radio power lookup tables
+  uint32_t radioPowerLevels = 100;
+  // RRC-idle UEs per mmWave eNB kept as records; the uesPerEnb UE devices then only carry
+  // the sessions paged from them. Zero disables
+  uint32_t idleUesPerEnb = 0;
+  IdleUeConfig idleConfig;
+  double idleTickInterval = 1.0;
+  // Target share of sessions finding no free UE device, sizing the device pool; zero keeps
+  // uesPerEnb devices per eNB
+  double poolBlocking = 0.0;
+  // Connected-mode DRX of the UEs, zero cycle to disable
+  DrxConfig drxConfig;
+  drxConfig.cycle = 0.0;
+  // Antenna muting and bandwidth-part reduction of lightly loaded mmWave cells
+  bool partialSleep = false;
+  double sleepControlInterval = 0.01;
+
   // Command line arguments
   CommandLine cmd;
+  cmd.AddValue ("perfCounters", "Report cycles, IPC and miss rates per phase (Linux only)",
+                perfCounters);
+  cmd.AddValue ("timeline", "Write a Chrome trace-event timeline to this file", timelineFile);
+  cmd.AddValue ("benchmark", "Write wall time, peak RSS and event rate to this JSON file",
+                benchmarkFile);
+  cmd.AddValue ("energyTrace", "Write the energy of every sampling tick to this file",
+                energyTraceFile);
+  cmd.AddValue ("kpiTrace", "Write the bits/J of every cell, pool and the network per tick",
+                kpiTraceFile);
+  cmd.AddValue ("mobilityTrace", "Write the UE positions to this file", mobilityTraceFile);
+  cmd.AddValue ("mobilityTraceInterval", "UE position sampling interval in seconds",
+                mobilityTraceInterval);
+  cmd.AddValue ("compressTraces",
+                "Compress the energy and mobility traces (read them with oran-trace-cat)",
+                compressTraces);
+  cmd.AddValue ("plotDir", "Write the FPA convergence and per-cell power plot series here",
+                plotDir);
+  cmd.AddValue ("plotPoints", "Maximum points of each plot series", plotPoints);
+  cmd.AddValue ("resultsStore", "Append the parameters and totals of this run to this store",
+                resultsStoreDir);
+  cmd.AddValue ("trajectoryFile", "Move the UEs along the tracks of this trajectory file",
+                trajectoryFile);
+  cmd.AddValue ("mmWaveEnbs", "Number of mmWave eNBs", nMmWaveEnbNodes);
+  cmd.AddValue ("uesPerEnb", "Number of UEs per mmWave eNB", ues);
+  cmd.AddValue ("simTime", "Simulated time in seconds", simTime);
+  cmd.AddValue ("dlInterval", "Downlink UDP packet interval in seconds, 0 disables traffic",
+                dlPacketInterval);
+  cmd.AddValue ("dlPacketSize", "Downlink UDP packet size in bytes", dlPacketSize);
+  cmd.AddValue ("optimizer", "Run the FPA DU/CU placement every interval", optimizer);
+  cmd.AddValue ("predictionHorizon",
+                "Place DUs/CUs for the serving cells predicted this many seconds ahead",
+                predictionHorizon);
+  cmd.AddValue ("radioPowerLevels", "Load levels of the radio site power tables",
+                radioPowerLevels);
+  cmd.AddValue ("idleUesPerEnb",
+                "RRC-idle UEs per mmWave eNB kept as records and paged onto the UE devices",
+                idleUesPerEnb);
+  cmd.AddValue ("idleMeanTime", "Mean time between sessions of an idle UE in seconds",
+                idleConfig.meanIdleTime);
+  cmd.AddValue ("sessionDuration", "Mean session duration in seconds",
+                idleConfig.meanSessionDuration);
+  cmd.AddValue ("poolBlocking",
+                "Size the UE device pool for this share of sessions finding no free device",
+                poolBlocking);
+  cmd.AddValue ("idleTickInterval", "Idle population paging step in seconds", idleTickInterval);
+  cmd.AddValue ("timerWheelTick",
+                "Run the EPM/CPM boot and idle timers on a timing wheel with this tick in "
+                "seconds; 0 schedules them as simulator events",
+                timerWheelTick);
+  cmd.AddValue ("lookahead",
+                "Simulate this many FPA placements in forked children at every RIC decision and "
+                "apply the best; 0 applies the FPA's best placement",
+                lookahead);
+  cmd.AddValue ("lookaheadHorizon", "What-if horizon in seconds, 0 for one RIC interval",
+                lookaheadHorizon);
+  cmd.AddValue ("realtime", "Synchronize the simulation with the wall clock", realtime);
+  cmd.AddValue ("ricDeadline", "Wall-clock deadline of the RIC loop in seconds, in real time",
+                ricDeadline);
+  cmd.AddValue ("maxLag",
+                "Shorten the FPA search while the simulation lags the wall clock by more than "
+                "this many seconds; 0 never degrades",
+                maxLag);
+  cmd.AddValue ("lagSampleInterval", "Real-time lag sampling step in seconds",
+                lagSampleInterval);
+  cmd.AddValue ("idealAttach",
+                "Exchange RRC messages ideally and without S1-AP delay, so that UEs attach "
+                "within the first milliseconds",
+                idealAttach);
+  cmd.AddValue ("drxCycle",
+                "DRX cycle of the UEs in seconds, downlink data waits for the on-duration; "
+                "0 disables DRX",
+                drxConfig.cycle);
+  cmd.AddValue ("drxOnDuration", "DRX on-duration in seconds", drxConfig.onDuration);
+  cmd.AddValue ("partialSleep", "Mute antennas and shrink the bandwidth of lightly loaded cells",
+                partialSleep);
+  cmd.AddValue ("sleepControlInterval",
+                "Radio energy integration and partial-sleep controller step in seconds",
+                sleepControlInterval);
+  cmd.AddValue ("nEpm", "Number of EPMs hosting DUs", orchestratorConfig.nEpm);
+  cmd.AddValue ("nCpm", "Number of CPMs hosting CUs", orchestratorConfig.nCpm);
+  cmd.AddValue ("fpaGenerations", "FPA generations per interval", orchestratorConfig.generations);
+  cmd.AddValue ("fpaPopulation", "FPA population size", orchestratorConfig.populationSize);
+  cmd.AddValue ("poolPowerStates",
+                "Boot and shut down EPMs/CPMs with wake-up delay and transition energy",
+                orchestratorConfig.poolPowerStates);
+  cmd.AddValue ("poolWakeUpDelay", "EPM/CPM boot time in seconds",
+                orchestratorConfig.poolPower.wakeUpDelay);
+  cmd.AddValue ("poolIdleTimeout", "Time an unloaded EPM/CPM stays on, in seconds",
+                orchestratorConfig.poolPower.idleTimeout);
+  cmd.AddValue ("coresPerPool",
+                "Model EPMs/CPMs as servers with this many cores, 0 for single-capacity pools",
+                orchestratorConfig.coresPerPool);
   cmd.Parse (argc, argv);
+  if (orchestratorConfig.populationSize < 2)
+    {
+      NS_LOG_UNCOND ("The FPA needs at least 2 flowers, using fpaPopulation=2");
+      orchestratorConfig.populationSize = 2;
+    }
+  if (orchestratorConfig.generations < 1)
+    {
+      NS_LOG_UNCOND ("The FPA needs at least 1 generation, using fpaGenerations=1");
+      orchestratorConfig.generations = 1;
+    }
 
+  // Must precede any other use of the simulator
+  if (realtime)
+    {
+      // Fall behind instead of aborting when events run slower than real time
+      Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizationMode",
+                          StringValue ("BestEffort"));
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::RealtimeSimulatorImpl"));
+    }
+  if (lookahead > 1 && realtime)
+    {
+      // Forked children cannot share the wall clock
+      NS_LOG_UNCOND ("What-if lookahead needs the default simulator, ignoring lookahead");
+      lookahead = 0;
+    }
+
+  if (perfCounters && !PerfCounters::Get ().Enable ())
+    {
+      NS_LOG_UNCOND ("Hardware performance counters unavailable: "
+                     << PerfCounters::Get ().GetError ());
+    }
+  if (!timelineFile.empty ())
+    {
+      TraceTimeline::Get ().Enable ();
+    }
+
+  // The downlink flow of every UE starts when its data radio bearer is set up
+  if (idealAttach)
+    {
+      // RRC messages are handed over directly instead of through the signaling radio bearers
+      // and the S1-AP path that activates the default bearers has no delay.  Random access
+      // and the RRC procedures still take their scheduling time, so bearers come up a few
+      // milliseconds into the run.  Attributes missing in the mmWave module in use are skipped.
+      const char *idealDefaults[][2] = {{"ns3::MmWaveHelper::UseIdealRrc", "true"},
+                                        {"ns3::LteHelper::UseIdealRrc", "true"},
+                                        {"ns3::MmWavePointToPointEpcHelper::S1apLinkDelay", "0s"},
+                                        {"ns3::PointToPointEpcHelper::S1apLinkDelay", "0s"}};
+      for (const auto &d : idealDefaults)
+        {
+          if (!Config::SetDefaultFailSafe (d[0], StringValue (d[1])))
+            {
+              NS_LOG_UNCOND ("Ideal attach: " << d[0] << " not available");
+            }
+        }
+    }
+
+  ScenarioPhase phaseHelpers ("setup.helpers", "setup");
   Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
   mmwaveHelper->SetPathlossModelType ("ns3::ThreeGppUmiStreetCanyonPropagationLossModel");
   mmwaveHelper->SetChannelConditionModelType ("ns3::ThreeGppUmiStreetCanyonChannelConditionModel");
@@ -146,12 +1378,21 @@ main (int argc, char *argv[])
   Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
   mmwaveHelper->SetEpcHelper (epcHelper);
 
-  uint8_t nMmWaveEnbNodes = 4;
-  uint8_t nLteEnbNodes = 1;
-  uint32_t ues = 3;
-  uint8_t nUeNodes = ues * nMmWaveEnbNodes;
+  uint32_t nUeNodes = ues * nMmWaveEnbNodes;
+  if (idleUesPerEnb > 0 && poolBlocking > 0)
+    {
+      // Size the UE device pool to the concurrent sessions the idle population offers
+      uint32_t nIdle = idleUesPerEnb * nMmWaveEnbNodes;
+      double erlangs = nIdle * idleConfig.meanSessionDuration /
+                       (idleConfig.meanIdleTime + idleConfig.meanSessionDuration);
+      nUeNodes = UeDevicePool::SizeForLoad (erlangs, poolBlocking, nIdle);
+      NS_LOG_UNCOND ("UE device pool of " << nUeNodes << " for " << erlangs
+                                          << " Erlang of sessions");
+    }
+  phaseHelpers.Stop ();
 
   // Get SGW/PGW and create a single RemoteHost
+  ScenarioPhase phaseInternet ("setup.internet", "setup");
   Ptr<Node> pgw = epcHelper->GetPgwNode ();
   NodeContainer remoteHostContainer;
   remoteHostContainer.Create (1);
@@ -169,8 +1410,10 @@ main (int argc, char *argv[])
   ipv4h.SetBase ("1.0.0.0", "255.0.0.0");
   Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign (internetDevices);
   Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress (1);
+  phaseInternet.Stop ();
 
   // Create LTE, mmWave eNB nodes and UE node
+  ScenarioPhase phaseNodes ("setup.nodes", "setup");
   NodeContainer ueNodes;
   NodeContainer mmWaveEnbNodes;
   NodeContainer lteEnbNodes;
@@ -178,6 +1421,8 @@ main (int argc, char *argv[])
   mmWaveEnbNodes.Create (nMmWaveEnbNodes);
   lteEnbNodes.Create (nLteEnbNodes);
   ueNodes.Create (nUeNodes);
+  allEnbNodes.Add (lteEnbNodes);
+  allEnbNodes.Add (mmWaveEnbNodes);
 
   // Install mobility models
   MobilityHelper mobility;
@@ -193,36 +1438,391 @@ main (int argc, char *argv[])
                                    "Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=4000.0]"));
   ueMobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
                                "Bounds", RectangleValue (Rectangle (0, 4000, 0, 4000)));
-  ueMobility.Install (ueNodes);
+  Ptr<TrajectoryFile> trajectories;
+  if (!trajectoryFile.empty ())
+    {
+      trajectories = Create<TrajectoryFile> ();
+      if (!trajectories->Open (trajectoryFile) || trajectories->GetNTracks () == 0)
+        {
+          NS_LOG_ERROR ("Can't open trajectory file " << trajectoryFile);
+          trajectories = nullptr;
+        }
+    }
+  if (trajectories)
+    {
+      // UE u follows track u, wrapping around when there are fewer tracks than UEs
+      for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+        {
+          Ptr<TrajectoryMobilityModel> model = CreateObject<TrajectoryMobilityModel> ();
+          model->SetTrajectory (trajectories, u % trajectories->GetNTracks ());
+          ueNodes.Get (u)->AggregateObject (model);
+        }
+    }
+  else
+    {
+      ueMobility.Install (ueNodes);
+    }
+  phaseNodes.Stop ();
 
   // Install network devices
+  ScenarioPhase phaseDevices ("setup.devices", "setup");
   NetDeviceContainer lteEnbDevs = mmwaveHelper->InstallLteEnbDevice (lteEnbNodes);
   NetDeviceContainer mmWaveEnbDevs = mmwaveHelper->InstallEnbDevice (mmWaveEnbNodes);
   NetDeviceContainer ueDevs = mmwaveHelper->InstallMcUeDevice (ueNodes);
 
+  // Install the IP stack on the UEs and route the remote host towards them
+  internet.Install (ueNodes);
+  Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address (ueDevs);
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+      ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
+  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      Ptr<Ipv4StaticRouting> ueStaticRouting =
+          ipv4RoutingHelper.GetStaticRouting (ueNodes.Get (u)->GetObject<Ipv4> ());
+      ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+    }
+  phaseDevices.Stop ();
+
   // Attach UEs to the network
+  ScenarioPhase phaseAttach ("setup.attach", "setup");
   mmwaveHelper->AttachToClosestEnb (ueDevs, mmWaveEnbDevs, lteEnbDevs);
+  phaseAttach.Stop ();
+
+  // Downlink UDP flow from the remote host to every UE, from the setup of its bearer
+  // Under DRX or with an idle population the remote host sends through plain sockets, in
+  // bursts timed by the DRX scheduler or to the UE devices hosting a session
+  ApplicationContainer serverApps;
+  std::vector<UdpClientHelper> dlClients;
+  std::vector<Ptr<Socket>> dlSockets;
+  bool drx = drxConfig.cycle > 0 && dlPacketInterval > 0;
+  bool pacedDl = dlPacketInterval > 0 && (drx || idleUesPerEnb > 0);
+  if (dlPacketInterval > 0)
+    {
+      uint16_t dlPort = 1234;
+      for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+        {
+          PacketSinkHelper dlPacketSinkHelper ("ns3::UdpSocketFactory",
+                                               InetSocketAddress (Ipv4Address::GetAny (), dlPort));
+          serverApps.Add (dlPacketSinkHelper.Install (ueNodes.Get (u)));
+          if (pacedDl)
+            {
+              Ptr<Socket> socket =
+                  Socket::CreateSocket (remoteHost, UdpSocketFactory::GetTypeId ());
+              socket->Connect (InetSocketAddress (ueIpIface.GetAddress (u), dlPort));
+              dlSockets.push_back (socket);
+              continue;
+            }
+          UdpClientHelper dlClient (ueIpIface.GetAddress (u), dlPort);
+          dlClient.SetAttribute ("Interval", TimeValue (Seconds (dlPacketInterval)));
+          dlClient.SetAttribute ("PacketSize", UintegerValue (dlPacketSize));
+          dlClient.SetAttribute ("MaxPackets", UintegerValue (0xFFFFFFFF));
+          dlClients.push_back (dlClient);
+        }
+      serverApps.Start (Seconds (0));
+    }
 
   // Simulation configuration
-  double alpha = 0.5;
-  double beta = 10.0;
-  double T = 1.0;
+  Ptr<ScenarioState> state = Create<ScenarioState> ();
+  state->ueNodes = ueNodes;
+  state->ueDevs = ueDevs;
+  for (uint32_t i = 0; i < mmWaveEnbDevs.GetN (); ++i)
+    {
+      uint16_t cellId = DynamicCast<MmWaveEnbNetDevice> (mmWaveEnbDevs.Get (i))->GetCellId ();
+      state->duIndex[cellId] = i;
+      state->cellIds.push_back (cellId);
+      state->enbPhys.push_back (DynamicCast<MmWaveEnbNetDevice> (mmWaveEnbDevs.Get (i))->GetPhy ());
+      state->enbTxPower.push_back (state->enbPhys.back ()->GetTxPower ());
+    }
+  for (uint32_t i = 0; i < serverApps.GetN (); ++i)
+    {
+      state->sinks.push_back (DynamicCast<PacketSink> (serverApps.Get (i)));
+    }
+  state->lastRx.assign (state->sinks.size (), 0);
+  for (uint32_t i = 0; i < mmWaveEnbNodes.GetN (); ++i)
+    {
+      Vector pos = mmWaveEnbNodes.Get (i)->GetObject<MobilityModel> ()->GetPosition ();
+      state->cellX.push_back (pos.x);
+      state->cellY.push_back (pos.y);
+    }
+  for (uint32_t u = 0; u < ueDevs.GetN (); ++u)
+    {
+      uint64_t imsi = DynamicCast<McUeNetDevice> (ueDevs.Get (u))->GetImsi ();
+      state->ueEnergy.AddUe (imsi, 0.0);
+      state->ueIndex[imsi] = u;
+    }
+  state->lastUeEnergy.assign (ueDevs.GetN (), 0.0);
+  state->ueCharged.assign (ueDevs.GetN (), 0.0);
+  state->bearerUp.assign (ueDevs.GetN (), 0);
+  state->remoteHost = remoteHost;
+  state->dlClients = dlClients;
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/ConnectionReconfiguration",
+                                 MakeBoundCallback (&UeBearerTrace, state));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/StateTransition",
+                                 MakeBoundCallback (&UeRrcStateTrace, state));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/HandoverEndOk",
+                                 MakeBoundCallback (&UeHandoverTrace, state));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/MmWaveUePhy/ReportDownlinkTbSize",
+                                 MakeBoundCallback (&UeDownlinkTbTrace, state));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/MmWaveUePhy/ReportUplinkTbSize",
+                                 MakeBoundCallback (&UeUplinkTbTrace, state));
+  state->mmWaveRadio = RadioPowerModel (RadioSiteConfig::MmWaveSmallCell (), radioPowerLevels);
+  state->lteRadio = RadioPowerModel (RadioSiteConfig::LteMacro (), radioPowerLevels);
+  state->nLteCells = nLteEnbNodes;
+  state->kpi.Resize (mmWaveEnbDevs.GetN (), orchestratorConfig.nEpm, orchestratorConfig.nCpm);
+  orchestratorConfig.alpha = state->alpha;
+  orchestratorConfig.beta = state->beta;
+  orchestratorConfig.convergencePoints = plotPoints;
+  if (!plotDir.empty ())
+    {
+      state->cellPower.assign (mmWaveEnbDevs.GetN (), StreamingDownsampler (plotPoints));
+    }
+  if (realtime)
+    {
+      state->realtime.reset (new RealtimeMonitor (maxLag, ricDeadline));
+      // The real-time simulator starts its clock at Run (), not at setup: start the
+      // monitor before any other event at t = 0
+      Simulator::Schedule (Seconds (0.0), &RealtimeMonitor::Start, state->realtime.get (), 0.0);
+      Simulator::Schedule (Seconds (lagSampleInterval), &RealtimeLagTick, state,
+                           Seconds (lagSampleInterval));
+    }
+  if (optimizer && predictionHorizon > 0)
+    {
+      state->predictor.reset (new MobilityPredictor (ueNodes.GetN ()));
+      state->predictionHorizon = predictionHorizon;
+      state->ueX.assign (ueNodes.GetN (), 0.0);
+      state->ueY.assign (ueNodes.GetN (), 0.0);
+      state->predictedDu.assign (ueNodes.GetN (), -1);
+      state->nearestDu.assign (ueNodes.GetN (), -1);
+      state->lastPredictedDu.assign (ueNodes.GetN (), -1);
+    }
+  if (optimizer)
+    {
+      orchestratorConfig.candidates = std::max<uint32_t> (lookahead, 1);
+      state->orchestrator = Create<EnergyOrchestrator> (orchestratorConfig, mmWaveEnbDevs.GetN (),
+                                                         mmWaveEnbDevs.GetN ());
+      // Fixed streams: the FPA draws depend on the seed and run number only, not on how
+      // many random variables the rest of the scenario created before it
+      state->orchestrator->AssignStreams (1000);
+      state->fpaGenerations = orchestratorConfig.generations;
+      if (timerWheelTick > 0)
+        {
+          state->timers.reset (new TimerWheel (Seconds (timerWheelTick)));
+          state->orchestrator->SetTimerWheel (state->timers.get ());
+        }
+      if (lookahead > 1)
+        {
+          state->whatIf.reset (new WhatIfLookahead ());
+          state->lookaheadHorizon = lookaheadHorizon > 0 ? lookaheadHorizon : state->T;
+        }
+      Simulator::Schedule (Seconds (0.0), &RicControlLoop, state);
+    }
 
-  for (uint32_t i = 0; i < ueNodes.GetN (); ++i)
+  if (!energyTraceFile.empty ())
     {
-      Ptr<Node> ue = ueNodes.Get (i);
-      double energyProcessing;
-      double energyMigration;
-      CalculateEnergyConsumption (ue, energyProcessing, energyMigration, alpha, beta, T);
+      state->energyTrace = OpenTraceFile (energyTraceFile, compressTraces);
+      if (state->energyTrace)
+        {
+          *state->energyTrace << "# time(s)\tEPM/CPM processing(J)\tUE processing(J)"
+                                 "\tUE migration(J)\tradio(J)\tUE device(J)"
+                              << std::endl;
+        }
+    }
+  if (!kpiTraceFile.empty ())
+    {
+      state->kpiTrace = OpenTraceFile (kpiTraceFile, compressTraces);
+      if (state->kpiTrace)
+        {
+          *state->kpiTrace << "# time(s)\tscope\tid\tbits\tJ\tbits/J\tcumulative bits/J"
+                           << std::endl;
+        }
+    }
+  if (!mobilityTraceFile.empty ())
+    {
+      state->mobilityTrace = OpenTraceFile (mobilityTraceFile, compressTraces);
+      if (state->mobilityTrace)
+        {
+          *state->mobilityTrace << "# time(s)\tIMSI\tx(m)\ty(m)" << std::endl;
+          Simulator::Schedule (Seconds (0.0), &MobilityTraceTick, state,
+                               Seconds (mobilityTraceInterval));
+        }
+    }
 
-      NS_LOG_UNCOND ("UE " << i << ": Processing Energy = " << energyProcessing
-                           << " J, Migration Energy = " << energyMigration << " J");
+  if (pacedDl)
+    {
+      state->dlSockets = dlSockets;
+      state->dlPacketInterval = dlPacketInterval;
+      state->dlPacketSize = dlPacketSize;
+    }
+  if (idleUesPerEnb > 0)
+    {
+      state->idle.reset (new IdleUePopulation (idleConfig));
+      Ptr<UniformRandomVariable> position = CreateObject<UniformRandomVariable> ();
+      for (uint32_t i = 0; i < idleUesPerEnb * nMmWaveEnbNodes; ++i)
+        {
+          state->idle->Add (position->GetValue (0.0, maxXAxis), position->GetValue (0.0, maxYAxis),
+                            0.0);
+        }
+      state->pool = UeDevicePool (ueNodes.GetN ());
+      state->sessionEnd.assign (ueNodes.GetN (), 0.0);
+      Simulator::Schedule (Seconds (0.0), &IdlePopulationTick, state, Seconds (idleTickInterval));
+      if (dlPacketInterval > 0 && !drx)
+        {
+          Simulator::Schedule (Seconds (0.0), &SessionTrafficTick, state);
+        }
     }
+  if (drx)
+    {
+      state->drx.reset (new DrxScheduler (drxConfig));
+      state->drx->SetUes (ueNodes.GetN ());
+      state->drx->SetWakeCallback (MakeBoundCallback (&DrxWake, state));
+      state->drxPending.assign (ueNodes.GetN (), 0.0);
+      Simulator::Schedule (Seconds (0.0), &DrxScheduler::Start, state->drx.get ());
+    }
+  if (partialSleep)
+    {
+      state->sleep.reset (new PartialSleepController (RadioSiteConfig::MmWaveSmallCell (),
+                                                      DefaultPartialSleepStates (),
+                                                      mmWaveEnbDevs.GetN (), radioPowerLevels));
+      state->sleep->SetStateChangeCallback (MakeBoundCallback (&ApplySleepState, state));
+      state->sleepLastRx.assign (state->sinks.size (), 0);
+      state->sleepControlInterval = sleepControlInterval;
+      Simulator::Schedule (Seconds (0.0), &SleepControlTick, state,
+                           Seconds (sleepControlInterval));
+    }
+  else
+    {
+      state->radioEnergy.assign (mmWaveEnbDevs.GetN (), 0.0);
+      state->radioLastRx.assign (state->sinks.size (), 0);
+      Simulator::Schedule (Seconds (sleepControlInterval), &RadioEnergyTick, state,
+                           Seconds (sleepControlInterval));
+    }
+  // The first sample covers the first interval; the events at simTime do not run, so the
+  // last interval is sampled once the run stops
+  Simulator::Schedule (Seconds (state->T), &EnergySamplingTick, state);
 
-  Simulator::Stop (Seconds (10.0));
+  Simulator::Stop (Seconds (simTime));
+  ScenarioPhase phaseRun ("Simulator::Run", "simulator");
+  auto runStart = std::chrono::steady_clock::now ();
   Simulator::Run ();
+  SampleEnergy (state);
+  if (state->whatIf && state->whatIf->IsChild ())
+    {
+      // The run ended inside a what-if horizon: report what it reached
+      WhatIfReport (state);
+    }
+  auto runEnd = std::chrono::steady_clock::now ();
+  phaseRun.Stop ();
+  uint64_t eventCount = Simulator::GetEventCount ();
+  uint64_t rxBytes = 0;
+  for (Ptr<PacketSink> sink : state->sinks)
+    {
+      rxBytes += sink->GetTotalRx ();
+    }
   Simulator::Destroy ();
 
+  std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - wallStart;
+  if (!benchmarkFile.empty ())
+    {
+      std::chrono::duration<double> runWallTime = runEnd - runStart;
+      WriteBenchmarkReport (benchmarkFile, nMmWaveEnbNodes, nUeNodes, simTime, wallTime.count (),
+                            runWallTime.count (), eventCount);
+    }
+  if (!plotDir.empty ())
+    {
+      WritePlotSeries (plotDir, state);
+    }
+  if (!resultsStoreDir.empty ())
+    {
+      std::map<std::string, std::string> params;
+      params["mmWaveEnbs"] = std::to_string (nMmWaveEnbNodes);
+      params["uesPerEnb"] = std::to_string (ues);
+      params["simTime"] = FormatParam (simTime);
+      params["dlInterval"] = FormatParam (dlPacketInterval);
+      params["dlPacketSize"] = std::to_string (dlPacketSize);
+      params["optimizer"] = optimizer ? "true" : "false";
+      params["nEpm"] = std::to_string (orchestratorConfig.nEpm);
+      params["nCpm"] = std::to_string (orchestratorConfig.nCpm);
+      params["fpaGenerations"] = std::to_string (orchestratorConfig.generations);
+      params["fpaPopulation"] = std::to_string (orchestratorConfig.populationSize);
+      params["drxCycle"] = FormatParam (drxConfig.cycle);
+      params["idealAttach"] = idealAttach ? "true" : "false";
+      params["realtime"] = realtime ? "true" : "false";
+      params["lookahead"] = std::to_string (lookahead);
+      params["timerWheelTick"] = FormatParam (timerWheelTick);
+      params["predictionHorizon"] = FormatParam (predictionHorizon);
+      params["idleUesPerEnb"] = std::to_string (idleUesPerEnb);
+      params["poolBlocking"] = FormatParam (poolBlocking);
+      AppendToResultsStore (resultsStoreDir, params, state, rxBytes, simTime, wallTime.count (),
+                            eventCount);
+    }
+
+  state->energyTrace.reset ();
+  state->mobilityTrace.reset ();
+  state->kpiTrace.reset ();
+  TraceWriter::Get ().Shutdown ();
+
+  NS_LOG_UNCOND ("Network energy efficiency: " << state->kpi.GetNetwork ().GetBitsPerJoule ()
+                                                << " bits/J, "
+                                                << state->kpi.GetEnergyPerActiveUe ()
+                                                << " J per active UE and tick");
+  PerfCounters::Get ().Print (std::cout);
+  TraceWriter::Get ().Print (std::cout);
+  if (state->sleep)
+    {
+      NS_LOG_UNCOND ("Partial sleep: " << state->sleep->GetParkedControlSteps () << " of "
+                                       << state->sleep->GetControlSteps ()
+                                       << " per-cell controller steps skipped on parked cells");
+    }
+  if (state->idle)
+    {
+      NS_LOG_UNCOND ("Idle UEs: " << state->idle->GetN () << " registered, "
+                                  << state->idle->GetPages () << " pages; UE device pool: "
+                                  << state->pool.GetHits () << " hits, "
+                                  << state->pool.GetMisses () << " misses, at most "
+                                  << state->pool.GetPeakInUse () << " of "
+                                  << state->pool.GetN () << " in use");
+    }
+  if (state->drx)
+    {
+      NS_LOG_UNCOND ("DRX: " << state->drxPackets << " downlink packets sent in "
+                             << state->drx->GetWakeEvents () << " on-duration events");
+    }
+  if (state->timers)
+    {
+      NS_LOG_UNCOND ("Timer wheel: " << state->timers->GetInserted () << " timers ("
+                                     << state->timers->GetCancelled () << " cancelled) on "
+                                     << state->timers->GetEvents () << " simulator events, "
+                                     << state->timers->GetEventsRemoved ()
+                                     << " scheduler events removed");
+    }
+  if (state->whatIf)
+    {
+      NS_LOG_UNCOND ("What-if lookahead: " << state->whatIfOverrides << " of "
+                                           << state->whatIfDecisions
+                                           << " RIC decisions overrode the FPA's best placement, "
+                                           << state->whatIf->GetForks () << " children forked, "
+                                           << state->whatIf->GetFailures () << " failed");
+    }
+  if (state->realtime)
+    {
+      NS_LOG_UNCOND ("Real time: lag " << state->realtime->GetMeanLag () << " s mean, "
+                                       << state->realtime->GetMaxLag () << " s max; "
+                                       << state->realtime->GetMissedDeadlines () << " of "
+                                       << state->realtime->GetLoops ()
+                                       << " RIC loops missed their deadline, fidelity degraded "
+                                       << state->realtime->GetDegradations () << " times");
+    }
+  if (state->orchestrator)
+    {
+      state->orchestrator->GetArena ().Print (std::cout);
+    }
+  if (TraceTimeline::IsEnabled () && !TraceTimeline::Get ().Write (timelineFile))
+    {
+      NS_LOG_ERROR ("Can't open file " << timelineFile);
+    }
+
   NS_LOG_INFO ("Simulation Completed.");
   return 0;
 }
@@ -0,0 +1,266 @@
+#ifndef ORAN_DOWNSAMPLER_H
+#define ORAN_DOWNSAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Online downsampler of an (x, y) series for plotting, in bounded memory.
+ *
+ * The first and the latest points are kept aside, and the points between
+ * them are accumulated into at most 2 * maxPoints buckets of equal point
+ * count; when they are all full, adjacent buckets are merged pairwise and
+ * the bucket size doubles, so the whole series is never stored.  A bucket
+ * keeps its first, last, minimum and maximum points (the candidates the
+ * largest-triangle-three-buckets selection picks from) and the mean of its
+ * points.
+ *
+ * Write () regroups the buckets into maxPoints output buckets, picks one
+ * candidate of each by largest-triangle-three-buckets (the point forming
+ * the largest triangle with the previously picked point and the mean of
+ * the next bucket) and emits it with the bucket's y range as an envelope.
+ */
+class StreamingDownsampler
+{
+public:
+  explicit StreamingDownsampler (uint32_t maxPoints = 1000)
+    : m_maxPoints (std::max<uint32_t> (maxPoints, 3)),
+      m_bucketSize (1),
+      m_count (0),
+      m_head {0.0, 0.0},
+      m_tail {0.0, 0.0}
+  {
+    m_buckets.reserve (2 * m_maxPoints);
+  }
+
+  void
+  Add (double x, double y)
+  {
+    m_count++;
+    if (m_count == 1)
+      {
+        m_head = {x, y};
+        return;
+      }
+    if (m_count > 2)
+      {
+        Push (m_tail);
+      }
+    m_tail = {x, y};
+  }
+
+  /**
+   * \return the number of points added so far
+   */
+  uint64_t
+  GetCount (void) const
+  {
+    return m_count;
+  }
+
+  /**
+   * Plot-ready series: x, y and the min/max envelope of y.
+   */
+  struct Point
+  {
+    float x;
+    float y;
+    float yMin;
+    float yMax;
+  };
+
+  /**
+   * \return at most maxPoints points, first and last points included
+   */
+  std::vector<Point>
+  GetPoints (void) const
+  {
+    std::vector<Bucket> out = Regroup ();
+    std::vector<Point> points;
+    points.reserve (out.size ());
+    const Sample *prev = nullptr;
+    for (size_t i = 0; i < out.size (); i++)
+      {
+        const Bucket &b = out[i];
+        const Sample *pick = &b.first;
+        if (i + 1 == out.size ())
+          {
+            pick = &b.last;
+          }
+        else if (prev)
+          {
+            double nx = out[i + 1].sumX / out[i + 1].n;
+            double ny = out[i + 1].sumY / out[i + 1].n;
+            double bestArea = -1.0;
+            for (const Sample *c : {&b.first, &b.min, &b.max, &b.last})
+              {
+                double area = std::abs ((prev->x - nx) * (c->y - prev->y)
+                                        - (prev->x - c->x) * (ny - prev->y));
+                if (area > bestArea)
+                  {
+                    bestArea = area;
+                    pick = c;
+                  }
+              }
+          }
+        points.push_back ({static_cast<float> (pick->x), static_cast<float> (pick->y),
+                           static_cast<float> (b.min.y), static_cast<float> (b.max.y)});
+        prev = pick;
+      }
+    return points;
+  }
+
+  /**
+   * Write GetPoints () to a binary stream as little-endian float32 records
+   * (x, y, yMin, yMax), plotted with e.g.
+   *   plot 'f.bin' binary format='%4float' using 1:3:4 with filledcurves,
+   *        '' binary format='%4float' using 1:2 with lines
+   * \return false if the stream failed
+   */
+  bool
+  Write (std::ostream &out) const
+  {
+    std::vector<Point> points = GetPoints ();
+    out.write (reinterpret_cast<const char *> (points.data ()), points.size () * sizeof (Point));
+    return static_cast<bool> (out);
+  }
+
+private:
+  struct Sample
+  {
+    double x;
+    double y;
+  };
+
+  struct Bucket
+  {
+    Bucket (double x, double y)
+      : first {x, y},
+        last {x, y},
+        min {x, y},
+        max {x, y},
+        sumX (x),
+        sumY (y),
+        n (1)
+    {
+    }
+
+    void
+    Add (double x, double y)
+    {
+      last = {x, y};
+      min = y < min.y ? Sample {x, y} : min;
+      max = y > max.y ? Sample {x, y} : max;
+      sumX += x;
+      sumY += y;
+      n++;
+    }
+
+    void
+    Merge (const Bucket &o)
+    {
+      last = o.last;
+      min = o.min.y < min.y ? o.min : min;
+      max = o.max.y > max.y ? o.max : max;
+      sumX += o.sumX;
+      sumY += o.sumY;
+      n += o.n;
+    }
+
+    Sample first;
+    Sample last;
+    Sample min;
+    Sample max;
+    double sumX;
+    double sumY;
+    uint64_t n;
+  };
+
+  /**
+   * Add a point between the first and the latest ones.
+   */
+  void
+  Push (Sample p)
+  {
+    if (m_buckets.empty () || m_buckets.back ().n == m_bucketSize)
+      {
+        if (m_buckets.size () == 2 * m_maxPoints)
+          {
+            Compact ();
+          }
+        m_buckets.push_back (Bucket (p.x, p.y));
+      }
+    else
+      {
+        m_buckets.back ().Add (p.x, p.y);
+      }
+  }
+
+  void
+  Compact (void)
+  {
+    size_t j = 0;
+    for (size_t i = 0; i < m_buckets.size (); i += 2, j++)
+      {
+        m_buckets[j] = m_buckets[i];
+        if (i + 1 < m_buckets.size ())
+          {
+            m_buckets[j].Merge (m_buckets[i + 1]);
+          }
+      }
+    m_buckets.erase (m_buckets.begin () + j, m_buckets.end ());
+    m_bucketSize *= 2;
+  }
+
+  /**
+   * \return the first point, the buckets merged down to maxPoints - 2 and
+   * the last point, the first and last alone in their buckets as LTTB
+   * requires
+   */
+  std::vector<Bucket>
+  Regroup (void) const
+  {
+    std::vector<Bucket> out;
+    if (m_count == 0)
+      {
+        return out;
+      }
+    out.push_back (Bucket (m_head.x, m_head.y));
+    size_t inner = m_maxPoints - 2;
+    size_t n = m_buckets.size ();
+    for (size_t i = 0; i < n; i++)
+      {
+        size_t group = n <= inner ? i : i * inner / n;
+        if (out.size () < group + 2)
+          {
+            out.push_back (m_buckets[i]);
+          }
+        else
+          {
+            out.back ().Merge (m_buckets[i]);
+          }
+      }
+    if (m_count > 1)
+      {
+        out.push_back (Bucket (m_tail.x, m_tail.y));
+      }
+    return out;
+  }
+
+  uint32_t m_maxPoints;
+  uint64_t m_bucketSize; //!< points per bucket before it is closed
+  uint64_t m_count;
+  Sample m_head; //!< first point
+  Sample m_tail; //!< latest point
+  std::vector<Bucket> m_buckets; //!< points between m_head and m_tail
+};
+
+} // namespace ns3
+
+#endif /* ORAN_DOWNSAMPLER_H */
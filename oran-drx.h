@@ -0,0 +1,166 @@
+#ifndef ORAN_DRX_H
+#define ORAN_DRX_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Connected-mode DRX cycle shared by the UEs of a scenario.
+ */
+struct DrxConfig
+{
+  double cycle = 0.32;       //!< long DRX cycle (s)
+  double onDuration = 0.01;  //!< on-duration at the start of every cycle (s)
+  uint32_t nGroups = 8;      //!< distinct cycle offsets the UEs are spread over
+};
+
+/**
+ * DRX cycles of many UEs driven by a single timer.
+ *
+ * UEs are spread over nGroups cycle offsets, and the members of each group
+ * are kept contiguous in one array, so the on-durations of all UEs cost
+ * nGroups simulator events per cycle whatever the number of UEs.  At the
+ * start of a group's on-duration the wake callback gets the group's UE
+ * indices; everything the scenario would otherwise do per UE and per slot
+ * or per packet (e.g. feeding downlink data) is deferred to that call and
+ * the UEs are left alone for the rest of the cycle.
+ */
+class DrxScheduler
+{
+public:
+  explicit DrxScheduler (const DrxConfig &config)
+    : m_config (config),
+      m_nGroups (std::max<uint32_t> (config.nGroups, 1)),
+      m_start (m_nGroups + 1, 0),
+      m_nextGroup (0),
+      m_wakeEvents (0)
+  {
+  }
+
+  ~DrxScheduler ()
+  {
+    m_timer.Cancel ();
+  }
+
+  /**
+   * Assign nUes UEs round-robin to the groups.
+   */
+  void
+  SetUes (uint32_t nUes)
+  {
+    m_group.resize (nUes);
+    m_members.resize (nUes);
+    std::fill (m_start.begin (), m_start.end (), 0);
+    for (uint32_t i = 0; i < nUes; i++)
+      {
+        m_group[i] = i % m_nGroups;
+        m_start[m_group[i] + 1]++;
+      }
+    for (uint32_t g = 0; g < m_nGroups; g++)
+      {
+        m_start[g + 1] += m_start[g];
+      }
+    std::vector<uint32_t> next (m_start.begin (), m_start.end () - 1);
+    for (uint32_t i = 0; i < nUes; i++)
+      {
+        m_members[next[m_group[i]]++] = i;
+      }
+  }
+
+  /**
+   * Called with the UE indices of a group and their number at the start of
+   * the group's on-duration.
+   */
+  void
+  SetWakeCallback (Callback<void, const uint32_t *, uint32_t> cb)
+  {
+    m_onWake = cb;
+  }
+
+  /**
+   * Schedule the first on-duration of every group from now on.
+   */
+  void
+  Start (void)
+  {
+    m_nextGroup = 0;
+    m_timer = Simulator::Schedule (Seconds (0.0), &DrxScheduler::Wake, this);
+  }
+
+  /**
+   * \return whether UE i is in its on-duration at time now (s)
+   */
+  bool
+  IsAwake (uint32_t i, double now) const
+  {
+    double phase = std::fmod (now - GetOffset (m_group[i]), m_config.cycle);
+    if (phase < 0)
+      {
+        phase += m_config.cycle;
+      }
+    return phase < m_config.onDuration;
+  }
+
+  /**
+   * \return the offset of a group's on-duration within the cycle (s)
+   */
+  double
+  GetOffset (uint32_t group) const
+  {
+    return m_config.cycle * group / m_nGroups;
+  }
+
+  const DrxConfig &
+  GetConfig (void) const
+  {
+    return m_config;
+  }
+
+  /**
+   * \return the number of on-duration events run so far
+   */
+  uint64_t
+  GetWakeEvents (void) const
+  {
+    return m_wakeEvents;
+  }
+
+private:
+  void
+  Wake (void)
+  {
+    uint32_t g = m_nextGroup;
+    m_wakeEvents++;
+    uint32_t n = m_start[g + 1] - m_start[g];
+    if (n > 0 && !m_onWake.IsNull ())
+      {
+        m_onWake (m_members.data () + m_start[g], n);
+      }
+    m_nextGroup = (g + 1) % m_nGroups;
+    m_timer = Simulator::Schedule (Seconds (m_config.cycle / m_nGroups), &DrxScheduler::Wake,
+                                   this);
+  }
+
+  DrxConfig m_config;
+  uint32_t m_nGroups;
+  std::vector<uint32_t> m_group;   //!< group of every UE
+  std::vector<uint32_t> m_start;   //!< first member of every group in m_members
+  std::vector<uint32_t> m_members; //!< UE indices, grouped
+  uint32_t m_nextGroup;
+  EventId m_timer;
+  uint64_t m_wakeEvents;
+  Callback<void, const uint32_t *, uint32_t> m_onWake;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_DRX_H */
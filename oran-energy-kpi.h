@@ -0,0 +1,169 @@
+#ifndef ORAN_ENERGY_KPI_H
+#define ORAN_ENERGY_KPI_H
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Delivered bits against consumed energy of one scope (a cell, a pool or
+ * the whole network), for the last sampling interval and since the start.
+ */
+struct EfficiencyCounter
+{
+  void
+  Add (double bits, double joules)
+  {
+    intervalBits = bits;
+    intervalJoules = joules;
+    totalBits += bits;
+    totalJoules += joules;
+  }
+
+  /**
+   * \return bits per joule of the last interval, NaN without energy
+   */
+  double
+  GetIntervalBitsPerJoule (void) const
+  {
+    return intervalJoules > 0 ? intervalBits / intervalJoules : NAN;
+  }
+
+  /**
+   * \return bits per joule since the start, NaN without energy
+   */
+  double
+  GetBitsPerJoule (void) const
+  {
+    return totalJoules > 0 ? totalBits / totalJoules : NAN;
+  }
+
+  double intervalBits = 0.0;
+  double intervalJoules = 0.0;
+  double totalBits = 0.0;
+  double totalJoules = 0.0;
+};
+
+/**
+ * Online energy-efficiency KPIs, updated once per energy sampling tick
+ * from that tick's energy and delivered-traffic deltas: bits/J per cell,
+ * per EPM, per CPM and network-wide, and network energy per active UE.
+ */
+class EnergyKpiTracker
+{
+public:
+  void
+  Resize (uint32_t nCells, uint32_t nEpm, uint32_t nCpm)
+  {
+    m_cell.assign (nCells, EfficiencyCounter ());
+    m_epm.assign (nEpm, EfficiencyCounter ());
+    m_cpm.assign (nCpm, EfficiencyCounter ());
+  }
+
+  EfficiencyCounter &
+  Cell (uint32_t i)
+  {
+    return m_cell[i];
+  }
+
+  EfficiencyCounter &
+  Epm (uint32_t i)
+  {
+    return m_epm[i];
+  }
+
+  EfficiencyCounter &
+  Cpm (uint32_t i)
+  {
+    return m_cpm[i];
+  }
+
+  /**
+   * Account the network-wide energy and traffic of the last interval.
+   * \param activeUes UEs that received data during the interval
+   */
+  void
+  AddNetwork (double bits, double joules, uint32_t activeUes)
+  {
+    m_network.Add (bits, joules);
+    m_intervalActiveUes = activeUes;
+    if (activeUes > 0)
+      {
+        m_activeUeJoules += joules;
+        m_activeUeSamples += activeUes;
+      }
+  }
+
+  const EfficiencyCounter &
+  GetNetwork (void) const
+  {
+    return m_network;
+  }
+
+  /**
+   * \return network energy of the last interval per active UE (J), NaN if
+   * no UE was active
+   */
+  double
+  GetIntervalEnergyPerActiveUe (void) const
+  {
+    return m_intervalActiveUes > 0 ? m_network.intervalJoules / m_intervalActiveUes : NAN;
+  }
+
+  /**
+   * \return energy per active UE since the start (J): the energy of the
+   * intervals with traffic over the summed number of active UEs
+   */
+  double
+  GetEnergyPerActiveUe (void) const
+  {
+    return m_activeUeSamples > 0 ? m_activeUeJoules / m_activeUeSamples : NAN;
+  }
+
+  /**
+   * Write one line per scope, "time scope id bits J bits/J cumulative-bits/J",
+   * cells labelled with cellIds.
+   */
+  void
+  WriteInterval (std::ostream &os, double now, const std::vector<uint16_t> &cellIds) const
+  {
+    WriteLine (os, now, "network", 0, m_network);
+    for (size_t i = 0; i < m_cell.size (); i++)
+      {
+        WriteLine (os, now, "cell", cellIds[i], m_cell[i]);
+      }
+    for (size_t i = 0; i < m_epm.size (); i++)
+      {
+        WriteLine (os, now, "epm", i, m_epm[i]);
+      }
+    for (size_t i = 0; i < m_cpm.size (); i++)
+      {
+        WriteLine (os, now, "cpm", i, m_cpm[i]);
+      }
+  }
+
+private:
+  static void
+  WriteLine (std::ostream &os, double now, const char *scope, uint32_t id,
+             const EfficiencyCounter &c)
+  {
+    os << now << "\t" << scope << "\t" << id << "\t" << c.intervalBits << "\t" << c.intervalJoules
+       << "\t" << c.GetIntervalBitsPerJoule () << "\t" << c.GetBitsPerJoule () << "\n";
+  }
+
+  std::vector<EfficiencyCounter> m_cell;
+  std::vector<EfficiencyCounter> m_epm;
+  std::vector<EfficiencyCounter> m_cpm;
+  EfficiencyCounter m_network;
+  uint32_t m_intervalActiveUes = 0;
+  double m_activeUeJoules = 0.0;
+  uint64_t m_activeUeSamples = 0;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_ENERGY_KPI_H */
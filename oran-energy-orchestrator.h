@@ -0,0 +1,628 @@
+#ifndef ORAN_ENERGY_ORCHESTRATOR_H
+#define ORAN_ENERGY_ORCHESTRATOR_H
+
+#include "oran-downsampler.h"
+#include "oran-pool-power-state.h"
+#include "oran-scratch-arena.h"
+#include "oran-server-model.h"
+
+#include "ns3/assert.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-ref-count.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Parameters of the EPM/CPM energy model and of the flower pollination
+ * search, with the defaults of Optimization_oran_fpa.py.
+ */
+struct OrchestratorConfig
+{
+  uint32_t nEpm = 2;
+  uint32_t nCpm = 2;
+  double pEpm = 200.0;      //!< static power of an active EPM (W)
+  double pPrimeEpm = 50.0;  //!< dynamic power of an EPM at full load (W)
+  double cEpm = 100.0;      //!< computational capacity of an EPM
+  double pCpm = 300.0;      //!< static power of an active CPM (W)
+  double pPrimeCpm = 60.0;  //!< dynamic power of a CPM at full load (W)
+  double cCpm = 120.0;      //!< computational capacity of a CPM
+  double alpha = 0.5;       //!< migration energy per unit of migrated data (J)
+  double beta = 10.0;       //!< fixed energy per migration (J)
+  double overloadPenalty = 1000.0; //!< fitness penalty per unit of load above capacity
+  uint32_t generations = 100;
+  uint32_t populationSize = 20;
+  uint32_t candidates = 1; //!< distinct placements kept by every search
+  double switchProbability = 0.8; //!< probability of global pollination
+  uint32_t convergencePoints = 1000; //!< points kept of the convergence series
+  uint32_t coresPerPool = 0; //!< 0: single-capacity pools, else multi-core servers
+  bool poolPowerStates = false; //!< pools boot and shut down instead of switching instantly
+  PoolPowerConfig poolPower;
+};
+
+/**
+ * Places DUs on EPMs and CUs on CPMs once per RIC interval with the flower
+ * pollination algorithm of Optimization_oran_fpa.py.
+ *
+ * A candidate holds one coordinate in [0, 1) per DU and per CU, decoded as
+ * pool index floor (x * nPools).  Its fitness is the energy of the interval:
+ * static plus load-proportional power of every active pool, plus
+ * alpha * V + beta for every DU or CU that leaves the pool it had in the
+ * previous interval, plus a penalty for load above a pool's capacity.
+ *
+ * All per-invocation containers (load vectors, the candidate matrix,
+ * fitness arrays) are std::pmr containers on GetArena (), which the caller
+ * resets once the interval's own inputs built there are out of scope.
+ */
+class EnergyOrchestrator : public SimpleRefCount<EnergyOrchestrator>
+{
+public:
+  static constexpr uint32_t UNPLACED = std::numeric_limits<uint32_t>::max ();
+
+  EnergyOrchestrator (const OrchestratorConfig &config, uint32_t nDu, uint32_t nCu)
+    : m_config (config),
+      m_nDu (nDu),
+      m_nCu (nCu),
+      m_duPool (nDu, UNPLACED),
+      m_cuPool (nCu, UNPLACED),
+      m_convergence (config.convergencePoints),
+      m_generation (0),
+      m_migrations (0)
+  {
+    // Local pollination mixes two flowers other than the one it moves
+    NS_ASSERT_MSG (config.populationSize >= 2, "EnergyOrchestrator: population below 2");
+    NS_ASSERT_MSG (config.generations >= 1, "EnergyOrchestrator: no FPA generation");
+    if (config.coresPerPool > 0)
+      {
+        ServerConfig epm = ServerConfig::ForPool (config.cEpm, config.pEpm, config.pPrimeEpm,
+                                                  config.coresPerPool);
+        ServerConfig cpm = ServerConfig::ForPool (config.cCpm, config.pCpm, config.pPrimeCpm,
+                                                  config.coresPerPool);
+        m_epmServers.assign (config.nEpm, MultiCoreServer (epm));
+        m_cpmServers.assign (config.nCpm, MultiCoreServer (cpm));
+      }
+    if (config.poolPowerStates)
+      {
+        m_epmStates.reset (new PoolPowerStateMachine (config.nEpm, config.poolPower));
+        m_cpmStates.reset (new PoolPowerStateMachine (config.nCpm, config.poolPower));
+      }
+    m_uniform = CreateObject<UniformRandomVariable> ();
+    m_normal = CreateObject<NormalRandomVariable> ();
+  }
+
+  int64_t
+  AssignStreams (int64_t stream)
+  {
+    m_uniform->SetStream (stream);
+    m_normal->SetStream (stream + 1);
+    return 2;
+  }
+
+  /**
+   * Search a placement for the next interval and apply it.
+   *
+   * \param duLoad computational load of each DU
+   * \param cuLoad computational load of each CU
+   * \param vDu data migrated when each DU changes EPM
+   * \param vCu data migrated when each CU changes CPM
+   * \param T interval length (s)
+   * \return fitness of the applied placement: energy over the interval
+   * including migrations (J), plus any overload penalty
+   */
+  double
+  Optimize (const double *duLoad, const double *cuLoad, const double *vDu, const double *vCu,
+            double T)
+  {
+    double bestFitness = Search (duLoad, cuLoad, vDu, vCu, T);
+    Apply (0, duLoad, cuLoad, vDu, vCu);
+    return bestFitness;
+  }
+
+  /**
+   * Search placements for the next interval without applying any.  Keeps
+   * the best placement found as candidate 0, followed by up to
+   * candidates - 1 other distinct placements of the final population in
+   * increasing fitness.  Arguments as for Optimize ().
+   *
+   * \return fitness of candidate 0
+   */
+  double
+  Search (const double *duLoad, const double *cuLoad, const double *vDu, const double *vCu,
+          double T)
+  {
+    double bestFitness;
+    {
+      const uint32_t dims = m_nDu + m_nCu;
+      const uint32_t n = m_config.populationSize;
+      std::pmr::vector<double> population (static_cast<size_t> (n) * dims, &m_arena);
+      std::pmr::vector<double> fitness (n, &m_arena);
+      std::pmr::vector<double> best (dims, &m_arena);
+
+      for (double &x : population)
+        {
+          x = m_uniform->GetValue (0.0, 1.0);
+        }
+      for (uint32_t i = 0; i < n; i++)
+        {
+          fitness[i] = Fitness (&population[i * dims], duLoad, cuLoad, vDu, vCu, T);
+        }
+      uint32_t bestIdx = std::min_element (fitness.begin (), fitness.end ()) - fitness.begin ();
+      bestFitness = fitness[bestIdx];
+      std::copy_n (&population[bestIdx * dims], dims, best.begin ());
+
+      for (uint32_t g = 0; g < m_config.generations; g++)
+        {
+          for (uint32_t i = 0; i < n; i++)
+            {
+              double *xi = &population[i * dims];
+              if (m_uniform->GetValue () < m_config.switchProbability)
+                {
+                  // Global pollination
+                  double l = m_normal->GetValue ();
+                  for (uint32_t d = 0; d < dims; d++)
+                    {
+                      xi[d] += l * (xi[d] - best[d]);
+                    }
+                }
+              else
+                {
+                  // Local pollination
+                  double epsilon = m_uniform->GetValue ();
+                  uint32_t j = m_uniform->GetInteger (0, n - 1);
+                  uint32_t k = m_uniform->GetInteger (0, n - 2);
+                  k += (k >= j) ? 1 : 0;
+                  const double *xj = &population[j * dims];
+                  const double *xk = &population[k * dims];
+                  for (uint32_t d = 0; d < dims; d++)
+                    {
+                      xi[d] += epsilon * (xj[d] - xk[d]);
+                    }
+                }
+              for (uint32_t d = 0; d < dims; d++)
+                {
+                  xi[d] = std::min (std::max (xi[d], 0.0), 1.0);
+                }
+            }
+          for (uint32_t i = 0; i < n; i++)
+            {
+              fitness[i] = Fitness (&population[i * dims], duLoad, cuLoad, vDu, vCu, T);
+              if (fitness[i] < bestFitness)
+                {
+                  bestFitness = fitness[i];
+                  std::copy_n (&population[i * dims], dims, best.begin ());
+                }
+            }
+          m_convergence.Add (m_generation++, bestFitness);
+        }
+
+      m_candidates.clear ();
+      m_candidateFitness.clear ();
+      AddCandidate (best.data (), bestFitness);
+      std::pmr::vector<uint32_t> order (n, &m_arena);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          order[i] = i;
+        }
+      std::sort (order.begin (), order.end (),
+                 [&fitness] (uint32_t a, uint32_t b) { return fitness[a] < fitness[b]; });
+      for (uint32_t i = 0; i < n && m_candidateFitness.size () < m_config.candidates; i++)
+        {
+          AddCandidate (&population[order[i] * dims], fitness[order[i]]);
+        }
+    }
+    return bestFitness;
+  }
+
+  /**
+   * Apply a placement kept by the last Search ().
+   * \return migration energy of the moves it made (J)
+   */
+  double
+  Apply (uint32_t candidate, const double *duLoad, const double *cuLoad, const double *vDu,
+         const double *vCu)
+  {
+    const uint32_t *pool = &m_candidates[static_cast<size_t> (candidate) * (m_nDu + m_nCu)];
+    double migration = 0.0;
+    for (uint32_t d = 0; d < m_nDu; d++)
+      {
+        if (m_duPool[d] != UNPLACED && m_duPool[d] != pool[d])
+          {
+            m_migrations++;
+            migration += m_config.alpha * vDu[d] + m_config.beta;
+          }
+        m_duPool[d] = pool[d];
+      }
+    for (uint32_t c = 0; c < m_nCu; c++)
+      {
+        if (m_cuPool[c] != UNPLACED && m_cuPool[c] != pool[m_nDu + c])
+          {
+            m_migrations++;
+            migration += m_config.alpha * vCu[c] + m_config.beta;
+          }
+        m_cuPool[c] = pool[m_nDu + c];
+      }
+    if (!m_epmServers.empty ())
+      {
+        PackServers (m_duPool.data (), duLoad, m_nDu, m_epmServers);
+        PackServers (m_cuPool.data (), cuLoad, m_nCu, m_cpmServers);
+      }
+    if (m_epmStates)
+      {
+        UpdatePowerStates (m_duPool.data (), duLoad, m_nDu, *m_epmStates, m_config.nEpm);
+        UpdatePowerStates (m_cuPool.data (), cuLoad, m_nCu, *m_cpmStates, m_config.nCpm);
+      }
+    return migration;
+  }
+
+  /**
+   * \return the number of placements kept by the last Search ()
+   */
+  uint32_t
+  GetNCandidates (void) const
+  {
+    return m_candidateFitness.size ();
+  }
+
+  double
+  GetCandidateFitness (uint32_t candidate) const
+  {
+    return m_candidateFitness[candidate];
+  }
+
+  /**
+   * \return processing energy over T of the current placement under the
+   * given loads, including the pools' wake-up and shutdown energy since
+   * the previous ProcessingEnergy () or SplitEnergy (); scratch comes from
+   * the arena, which the caller resets
+   */
+  double
+  ProcessingEnergy (const double *duLoad, const double *cuLoad, double T)
+  {
+    std::pmr::vector<double> epmEnergy (m_config.nEpm, &m_arena);
+    std::pmr::vector<double> cpmEnergy (m_config.nCpm, &m_arena);
+    double overload;
+    return PlacementEnergy (m_duPool.data (), m_cuPool.data (), duLoad, cuLoad, T, false,
+                            epmEnergy.data (), cpmEnergy.data (), overload);
+  }
+
+  /**
+   * Split the processing energy over T of the current placement, as
+   * reported by ProcessingEnergy (), per EPM and CPM, and per DU and CU as
+   * their load share of their pool's energy.  Scratch comes from the arena,
+   * which the caller resets.
+   */
+  void
+  SplitEnergy (const double *duLoad, const double *cuLoad, double T, double *epmEnergy,
+               double *cpmEnergy, double *duEnergy, double *cuEnergy)
+  {
+    double overload;
+    PlacementEnergy (m_duPool.data (), m_cuPool.data (), duLoad, cuLoad, T, false, epmEnergy,
+                     cpmEnergy, overload);
+    std::pmr::vector<double> epmLoad (m_config.nEpm, 0.0, &m_arena);
+    std::pmr::vector<double> cpmLoad (m_config.nCpm, 0.0, &m_arena);
+    for (uint32_t d = 0; d < m_nDu; d++)
+      {
+        epmLoad[PoolOf (m_duPool[d])] += duLoad[d];
+      }
+    for (uint32_t c = 0; c < m_nCu; c++)
+      {
+        cpmLoad[PoolOf (m_cuPool[c])] += cuLoad[c];
+      }
+    for (uint32_t d = 0; d < m_nDu; d++)
+      {
+        uint32_t pool = PoolOf (m_duPool[d]);
+        duEnergy[d] = epmLoad[pool] > 0 ? epmEnergy[pool] * duLoad[d] / epmLoad[pool] : 0.0;
+      }
+    for (uint32_t c = 0; c < m_nCu; c++)
+      {
+        uint32_t pool = PoolOf (m_cuPool[c]);
+        cuEnergy[c] = cpmLoad[pool] > 0 ? cpmEnergy[pool] * cuLoad[c] / cpmLoad[pool] : 0.0;
+      }
+  }
+
+  /**
+   * \return the EPM servers in the state of the applied placement, as of
+   * the last Apply () or energy accounting, empty with single-capacity pools
+   */
+  const std::vector<MultiCoreServer> &
+  GetEpmServers (void) const
+  {
+    return m_epmServers;
+  }
+
+  const std::vector<MultiCoreServer> &
+  GetCpmServers (void) const
+  {
+    return m_cpmServers;
+  }
+
+  /**
+   * \return the EPM power states, null when pools switch instantly
+   */
+  const PoolPowerStateMachine *
+  GetEpmPowerStates (void) const
+  {
+    return m_epmStates.get ();
+  }
+
+  const PoolPowerStateMachine *
+  GetCpmPowerStates (void) const
+  {
+    return m_cpmStates.get ();
+  }
+
+  ScratchArena &
+  GetArena (void)
+  {
+    return m_arena;
+  }
+
+  const std::vector<uint32_t> &
+  GetDuPlacement (void) const
+  {
+    return m_duPool;
+  }
+
+  const std::vector<uint32_t> &
+  GetCuPlacement (void) const
+  {
+    return m_cuPool;
+  }
+
+  /**
+   * \return the best fitness after every generation of every invocation,
+   * against the generation count, downsampled for plotting
+   */
+  const StreamingDownsampler &
+  GetConvergence (void) const
+  {
+    return m_convergence;
+  }
+
+  uint64_t
+  GetMigrations (void) const
+  {
+    return m_migrations;
+  }
+
+  const OrchestratorConfig &
+  GetConfig (void) const
+  {
+    return m_config;
+  }
+
+  /**
+   * Run the EPM/CPM boot and idle timers on a timing wheel.
+   */
+  void
+  SetTimerWheel (TimerWheel *wheel)
+  {
+    if (m_epmStates)
+      {
+        m_epmStates->SetTimerWheel (wheel);
+        m_cpmStates->SetTimerWheel (wheel);
+      }
+  }
+
+  /**
+   * Change the number of FPA generations of the next searches.
+   */
+  void
+  SetGenerations (uint32_t generations)
+  {
+    NS_ASSERT_MSG (generations >= 1, "EnergyOrchestrator: no FPA generation");
+    m_config.generations = generations;
+  }
+
+private:
+  static uint32_t
+  Decode (double x, uint32_t nPools)
+  {
+    return std::min (static_cast<uint32_t> (x * nPools), nPools - 1);
+  }
+
+  static uint32_t
+  PoolOf (uint32_t pool)
+  {
+    return pool == UNPLACED ? 0 : pool;
+  }
+
+  /**
+   * Keep the placement decoded from x unless an equal one is kept already.
+   */
+  void
+  AddCandidate (const double *x, double fitness)
+  {
+    const uint32_t dims = m_nDu + m_nCu;
+    size_t start = m_candidates.size ();
+    for (uint32_t d = 0; d < dims; d++)
+      {
+        m_candidates.push_back (Decode (x[d], d < m_nDu ? m_config.nEpm : m_config.nCpm));
+      }
+    for (size_t k = 0; k < start; k += dims)
+      {
+        if (std::equal (&m_candidates[k], &m_candidates[k] + dims, &m_candidates[start]))
+          {
+            m_candidates.resize (start);
+            return;
+          }
+      }
+    m_candidateFitness.push_back (fitness);
+  }
+
+  /**
+   * Energy over T of one set of pools hosting n workloads: static plus
+   * load-proportional power of every loaded pool, or the power of its
+   * multi-core server when servers are modeled.  With power states, the
+   * planned (plan) or spent energy of every pool in its off, booting or on
+   * state, and load waiting for a boot counts as overload.
+   */
+  double
+  PoolSetEnergy (const uint32_t *placement, const double *load, uint32_t n, uint32_t nPools,
+                 double capacity, double pStatic, double pDynamic,
+                 std::vector<MultiCoreServer> &servers, PoolPowerStateMachine *states, bool plan,
+                 double T, double *energy, double &overload)
+  {
+    std::pmr::vector<double> hosted (&m_arena);
+    hosted.reserve (n);
+    double total = 0.0;
+    for (uint32_t p = 0; p < nPools; p++)
+      {
+        hosted.clear ();
+        double l = 0.0;
+        for (uint32_t i = 0; i < n; i++)
+          {
+            if (PoolOf (placement[i]) == p)
+              {
+                hosted.push_back (load[i]);
+                l += load[i];
+              }
+          }
+        double loadedPower;
+        double idlePower;
+        if (servers.empty ())
+          {
+            loadedPower = pStatic + pDynamic * (l / capacity);
+            idlePower = pStatic;
+            overload += std::max (l - capacity, 0.0);
+          }
+        else
+          {
+            // Searches only plan: the servers keep the state of the applied placement
+            double serverOverload;
+            loadedPower = plan ? servers[p].Plan (hosted.data (), hosted.size (), serverOverload)
+                               : servers[p].Pack (hosted.data (), hosted.size (), serverOverload);
+            idlePower = servers[p].GetIdlePower ();
+            overload += serverOverload;
+          }
+        if (!states)
+          {
+            energy[p] = (l > 0) * loadedPower * T;
+          }
+        else if (plan)
+          {
+            double unserved;
+            energy[p] = states->PlanCost (p, l > 0, T, loadedPower, idlePower, unserved);
+            overload += l * unserved / T;
+          }
+        else
+          {
+            energy[p] = states->TakeEnergy (p, loadedPower, idlePower);
+          }
+        total += energy[p];
+      }
+    return total;
+  }
+
+  /**
+   * Put every server in the state of the placement hosting n workloads.
+   */
+  void
+  PackServers (const uint32_t *placement, const double *load, uint32_t n,
+               std::vector<MultiCoreServer> &servers)
+  {
+    std::pmr::vector<double> hosted (&m_arena);
+    hosted.reserve (n);
+    for (uint32_t p = 0; p < servers.size (); p++)
+      {
+        hosted.clear ();
+        for (uint32_t i = 0; i < n; i++)
+          {
+            if (PoolOf (placement[i]) == p)
+              {
+                hosted.push_back (load[i]);
+              }
+          }
+        double overload;
+        servers[p].Pack (hosted.data (), hosted.size (), overload);
+      }
+  }
+
+  static void
+  UpdatePowerStates (const uint32_t *placement, const double *load, uint32_t n,
+                     PoolPowerStateMachine &states, uint32_t nPools)
+  {
+    for (uint32_t p = 0; p < nPools; p++)
+      {
+        bool loaded = false;
+        for (uint32_t i = 0; i < n; i++)
+          {
+            loaded = loaded || (PoolOf (placement[i]) == p && load[i] > 0);
+          }
+        states.SetLoaded (p, loaded);
+      }
+  }
+
+  double
+  PlacementEnergy (const uint32_t *duPool, const uint32_t *cuPool, const double *duLoad,
+                   const double *cuLoad, double T, bool plan, double *epmEnergy,
+                   double *cpmEnergy, double &overload)
+  {
+    overload = 0.0;
+    return PoolSetEnergy (duPool, duLoad, m_nDu, m_config.nEpm, m_config.cEpm, m_config.pEpm,
+                          m_config.pPrimeEpm, m_epmServers, m_epmStates.get (), plan, T,
+                          epmEnergy, overload)
+           + PoolSetEnergy (cuPool, cuLoad, m_nCu, m_config.nCpm, m_config.cCpm, m_config.pCpm,
+                            m_config.pPrimeCpm, m_cpmServers, m_cpmStates.get (), plan, T,
+                            cpmEnergy, overload);
+  }
+
+  double
+  Fitness (const double *x, const double *duLoad, const double *cuLoad, const double *vDu,
+           const double *vCu, double T)
+  {
+    std::pmr::vector<uint32_t> duPool (m_nDu, &m_arena);
+    std::pmr::vector<uint32_t> cuPool (m_nCu, &m_arena);
+    std::pmr::vector<double> epmEnergy (m_config.nEpm, &m_arena);
+    std::pmr::vector<double> cpmEnergy (m_config.nCpm, &m_arena);
+    double migration = 0.0;
+    for (uint32_t d = 0; d < m_nDu; d++)
+      {
+        duPool[d] = Decode (x[d], m_config.nEpm);
+        if (m_duPool[d] != UNPLACED && m_duPool[d] != duPool[d])
+          {
+            migration += m_config.alpha * vDu[d] + m_config.beta;
+          }
+      }
+    for (uint32_t c = 0; c < m_nCu; c++)
+      {
+        cuPool[c] = Decode (x[m_nDu + c], m_config.nCpm);
+        if (m_cuPool[c] != UNPLACED && m_cuPool[c] != cuPool[c])
+          {
+            migration += m_config.alpha * vCu[c] + m_config.beta;
+          }
+      }
+    double overload;
+    double energy = PlacementEnergy (duPool.data (), cuPool.data (), duLoad, cuLoad, T, true,
+                                     epmEnergy.data (), cpmEnergy.data (), overload);
+    return energy + migration + m_config.overloadPenalty * overload;
+  }
+
+  OrchestratorConfig m_config;
+  uint32_t m_nDu;
+  uint32_t m_nCu;
+  std::vector<uint32_t> m_duPool;
+  std::vector<uint32_t> m_cuPool;
+  StreamingDownsampler m_convergence;
+  uint64_t m_generation;
+  uint64_t m_migrations;
+  std::vector<uint32_t> m_candidates; //!< pools of every DU then CU, per kept placement
+  std::vector<double> m_candidateFitness;
+  ScratchArena m_arena;
+  std::vector<MultiCoreServer> m_epmServers; //!< empty with single-capacity pools
+  std::vector<MultiCoreServer> m_cpmServers;
+  std::unique_ptr<PoolPowerStateMachine> m_epmStates; //!< null when pools switch instantly
+  std::unique_ptr<PoolPowerStateMachine> m_cpmStates;
+  Ptr<UniformRandomVariable> m_uniform;
+  Ptr<NormalRandomVariable> m_normal;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_ENERGY_ORCHESTRATOR_H */
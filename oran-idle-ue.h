@@ -0,0 +1,259 @@
+#ifndef ORAN_IDLE_UE_H
+#define ORAN_IDLE_UE_H
+
+#include "ns3/random-variable-stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Session and mobility statistics of the RRC-idle UE population.
+ */
+struct IdleUeConfig
+{
+  double meanIdleTime = 60.0;       //!< mean time between sessions of a UE (s)
+  double meanSessionDuration = 5.0; //!< mean time a UE stays active (s)
+  double speed = 1.5;               //!< walking speed of idle UEs (m/s)
+  double minX = 0.0;
+  double maxX = 4000.0;
+  double minY = 0.0;
+  double maxY = 4000.0;
+};
+
+/**
+ * Registered UEs that are not in a session, kept as compact records
+ * instead of full device stacks.
+ *
+ * Every record holds a position, a heading, the cell it is camped on and
+ * the time of its next session, each in an array indexed by record.  Due
+ * sessions come out of a heap keyed by time, so a tick only touches the
+ * records that page.  A record that starts a session is handed to the
+ * scenario, which maps it onto a full device, and comes back idle when the
+ * session ends.
+ */
+class IdleUePopulation
+{
+public:
+  explicit IdleUePopulation (const IdleUeConfig &config = IdleUeConfig ())
+    : m_config (config),
+      m_nActive (0),
+      m_maxActive (0),
+      m_pages (0),
+      m_blocked (0),
+      m_demotions (0)
+  {
+    m_uniform = CreateObject<UniformRandomVariable> ();
+    m_exponential = CreateObject<ExponentialRandomVariable> ();
+  }
+
+  /**
+   * Register a UE at a position, idle until its first session.
+   * \return its record index
+   */
+  uint32_t
+  Add (double x, double y, double now)
+  {
+    uint32_t i = m_x.size ();
+    m_x.push_back (x);
+    m_y.push_back (y);
+    double heading = m_uniform->GetValue (0.0, 2 * M_PI);
+    m_dx.push_back (std::cos (heading));
+    m_dy.push_back (std::sin (heading));
+    m_cell.push_back (0);
+    m_active.push_back (false);
+    m_due.push ({now + m_exponential->GetValue (m_config.meanIdleTime, 0.0), i});
+    return i;
+  }
+
+  /**
+   * Walk every idle record for dt, reflecting on the area bounds.
+   */
+  void
+  Move (double dt)
+  {
+    const IdleUeConfig &c = m_config;
+    double step = c.speed * dt;
+    for (size_t i = 0; i < m_x.size (); i++)
+      {
+        if (m_active[i])
+          {
+            continue;
+          }
+        m_x[i] += m_dx[i] * step;
+        m_y[i] += m_dy[i] * step;
+        if (m_x[i] < c.minX || m_x[i] > c.maxX)
+          {
+            m_dx[i] = -m_dx[i];
+            m_x[i] = std::min (std::max (m_x[i], c.minX), c.maxX);
+          }
+        if (m_y[i] < c.minY || m_y[i] > c.maxY)
+          {
+            m_dy[i] = -m_dy[i];
+            m_y[i] = std::min (std::max (m_y[i], c.minY), c.maxY);
+          }
+      }
+  }
+
+  /**
+   * Camp every idle record on the closest of nCells cells.
+   */
+  void
+  UpdateCamping (const double *cellX, const double *cellY, uint32_t nCells)
+  {
+    for (size_t i = 0; i < m_x.size (); i++)
+      {
+        if (m_active[i])
+          {
+            continue;
+          }
+        double best = INFINITY;
+        for (uint32_t c = 0; c < nCells; c++)
+          {
+            double dx = m_x[i] - cellX[c];
+            double dy = m_y[i] - cellY[c];
+            double d = dx * dx + dy * dy;
+            if (d < best)
+              {
+                best = d;
+                m_cell[i] = c;
+              }
+          }
+      }
+  }
+
+  /**
+   * Pop the idle records whose session starts by now into due.
+   */
+  void
+  CollectDue (double now, std::vector<uint32_t> &due)
+  {
+    due.clear ();
+    while (!m_due.empty () && m_due.top ().first <= now)
+      {
+        due.push_back (m_due.top ().second);
+        m_due.pop ();
+      }
+  }
+
+  /**
+   * Page record i into a session.
+   * \return the time the session ends (s)
+   */
+  double
+  Promote (uint32_t i, double now)
+  {
+    m_active[i] = true;
+    m_nActive++;
+    m_maxActive = std::max (m_maxActive, m_nActive);
+    m_pages++;
+    return now + m_exponential->GetValue (m_config.meanSessionDuration, 0.0);
+  }
+
+  /**
+   * Postpone the session of record i, paged while no device was free.
+   */
+  void
+  Block (uint32_t i, double now)
+  {
+    m_blocked++;
+    m_due.push ({now + m_exponential->GetValue (m_config.meanIdleTime, 0.0), i});
+  }
+
+  /**
+   * Return record i to idle at the position its device reached.
+   */
+  void
+  Demote (uint32_t i, double x, double y, double now)
+  {
+    m_active[i] = false;
+    m_nActive--;
+    m_demotions++;
+    m_x[i] = x;
+    m_y[i] = y;
+    m_due.push ({now + m_exponential->GetValue (m_config.meanIdleTime, 0.0), i});
+  }
+
+  double
+  GetX (uint32_t i) const
+  {
+    return m_x[i];
+  }
+
+  double
+  GetY (uint32_t i) const
+  {
+    return m_y[i];
+  }
+
+  uint32_t
+  GetCampedCell (uint32_t i) const
+  {
+    return m_cell[i];
+  }
+
+  uint32_t
+  GetN (void) const
+  {
+    return m_x.size ();
+  }
+
+  uint32_t
+  GetNIdle (void) const
+  {
+    return m_x.size () - m_nActive;
+  }
+
+  uint32_t
+  GetMaxActive (void) const
+  {
+    return m_maxActive;
+  }
+
+  uint64_t
+  GetPages (void) const
+  {
+    return m_pages;
+  }
+
+  uint64_t
+  GetBlocked (void) const
+  {
+    return m_blocked;
+  }
+
+  uint64_t
+  GetDemotions (void) const
+  {
+    return m_demotions;
+  }
+
+private:
+  typedef std::pair<double, uint32_t> Due; //!< session start time and record
+
+  IdleUeConfig m_config;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_dx; //!< unit heading
+  std::vector<double> m_dy;
+  std::vector<uint32_t> m_cell;
+  std::vector<uint8_t> m_active;
+  std::priority_queue<Due, std::vector<Due>, std::greater<Due>> m_due;
+  uint32_t m_nActive;
+  uint32_t m_maxActive;
+  uint64_t m_pages;
+  uint64_t m_blocked;
+  uint64_t m_demotions;
+  Ptr<UniformRandomVariable> m_uniform;
+  Ptr<ExponentialRandomVariable> m_exponential;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_IDLE_UE_H */
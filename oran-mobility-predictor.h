@@ -0,0 +1,134 @@
+#ifndef ORAN_MOBILITY_PREDICTOR_H
+#define ORAN_MOBILITY_PREDICTOR_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Per-UE position predictor for many UEs at once.
+ *
+ * Every UE has a constant-velocity alpha-beta filter (the steady-state
+ * form of a Kalman filter on position and velocity), updated from a
+ * position sample of all UEs per tick.  Positions and velocities live in
+ * one array per coordinate, indexed by UE, so Update () and Predict () are
+ * branch-free loops over all UEs.
+ */
+class MobilityPredictor
+{
+public:
+  /**
+   * \param alpha position gain in (0, 1]
+   * \param beta velocity gain in (0, 2)
+   */
+  MobilityPredictor (uint32_t nUes, double alpha = 0.5, double beta = 0.3)
+    : m_alpha (alpha),
+      m_beta (beta),
+      m_x (nUes, 0.0),
+      m_y (nUes, 0.0),
+      m_vx (nUes, 0.0),
+      m_vy (nUes, 0.0),
+      m_lastTime (NAN)
+  {
+  }
+
+  /**
+   * Correct every UE's filter with its measured position at time t (s).
+   * The first call only initializes the positions.
+   */
+  void
+  Update (const double *x, const double *y, double t)
+  {
+    const size_t n = m_x.size ();
+    if (std::isnan (m_lastTime))
+      {
+        m_x.assign (x, x + n);
+        m_y.assign (y, y + n);
+        m_lastTime = t;
+        return;
+      }
+    double dt = t - m_lastTime;
+    if (dt <= 0)
+      {
+        return;
+      }
+    const double a = m_alpha;
+    const double b = m_beta / dt;
+    for (size_t i = 0; i < n; i++)
+      {
+        double px = m_x[i] + m_vx[i] * dt;
+        double py = m_y[i] + m_vy[i] * dt;
+        double rx = x[i] - px;
+        double ry = y[i] - py;
+        m_x[i] = px + a * rx;
+        m_y[i] = py + a * ry;
+        m_vx[i] += b * rx;
+        m_vy[i] += b * ry;
+      }
+    m_lastTime = t;
+  }
+
+  /**
+   * Predict the position of every UE horizon seconds after the last update.
+   */
+  void
+  Predict (double horizon, double *x, double *y) const
+  {
+    for (size_t i = 0; i < m_x.size (); i++)
+      {
+        x[i] = m_x[i] + m_vx[i] * horizon;
+        y[i] = m_y[i] + m_vy[i] * horizon;
+      }
+  }
+
+  /**
+   * Predict the closest of nCells cells to every UE after horizon seconds.
+   */
+  void
+  PredictCells (double horizon, const double *cellX, const double *cellY, uint32_t nCells,
+                int32_t *cell)
+  {
+    m_px.resize (m_x.size ());
+    m_py.resize (m_x.size ());
+    Predict (horizon, m_px.data (), m_py.data ());
+    for (size_t i = 0; i < m_x.size (); i++)
+      {
+        double best = INFINITY;
+        cell[i] = -1;
+        for (uint32_t c = 0; c < nCells; c++)
+          {
+            double dx = m_px[i] - cellX[c];
+            double dy = m_py[i] - cellY[c];
+            double d = dx * dx + dy * dy;
+            if (d < best)
+              {
+                best = d;
+                cell[i] = c;
+              }
+          }
+      }
+  }
+
+  uint32_t
+  GetN (void) const
+  {
+    return m_x.size ();
+  }
+
+private:
+  double m_alpha;
+  double m_beta;
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_vx;
+  std::vector<double> m_vy;
+  std::vector<double> m_px; //!< scratch of PredictCells ()
+  std::vector<double> m_py;
+  double m_lastTime;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_MOBILITY_PREDICTOR_H */
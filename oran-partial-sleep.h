@@ -0,0 +1,319 @@
+#ifndef ORAN_PARTIAL_SLEEP_H
+#define ORAN_PARTIAL_SLEEP_H
+
+#include "oran-radio-power-model.h"
+
+#include "ns3/callback.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * A partial-sleep state of a radio site: a fraction of its transceiver
+ * chains (antenna subarrays) kept on and a fraction of its bandwidth kept
+ * active, at the price of the capacity left to the scheduler.
+ */
+struct PartialSleepState
+{
+  std::string name;
+  double antennaFraction;
+  double bandwidthFraction;
+  double capacityFactor; //!< share of the full-state peak rate still available
+};
+
+/**
+ * Partial-sleep states of mmWave sites, from full operation to the
+ * deepest state that still serves traffic, in decreasing capacity.
+ */
+inline std::vector<PartialSleepState>
+DefaultPartialSleepStates (void)
+{
+  return {{"full", 1.0, 1.0, 1.0},
+          {"mute-half", 0.5, 1.0, 0.8},
+          {"bwp-half", 0.5, 0.5, 0.4},
+          {"bwp-quarter", 0.25, 0.25, 0.15}};
+}
+
+/**
+ * Per-cell partial-sleep controller for many cells of one site type.
+ *
+ * Cell state is held as arrays indexed by cell (current state, ticks spent
+ * below the threshold) and the power of every state is one row of a single
+ * table indexed by quantized load, so Step () over all cells is a tight
+ * loop of table reads with no allocation, cheap enough to run every slot.
+ *
+ * A cell moves one state deeper when its load would stay below
+ * enterThreshold of the deeper state's capacity for holdSteps consecutive
+ * steps, and back to the full state as soon as its load exceeds
+ * exitThreshold of the current state's capacity.
+ *
+ * A cell that has carried no traffic for holdSteps steps in the deepest
+ * state is parked: Step () skips it until it sees traffic again, and its
+ * constant idle power is integrated over the whole parked time when it is
+ * woken up or its energy is taken.  Once every cell is parked the caller
+ * may stop stepping altogether and report the gap with SkipParked ().
+ * Parking only saves controller steps; the cell's own radio stack is not
+ * touched.
+ */
+class PartialSleepController
+{
+public:
+  PartialSleepController (const RadioSiteConfig &site,
+                          const std::vector<PartialSleepState> &states, uint32_t nCells,
+                          uint32_t nLevels = 100)
+    : m_states (states),
+      m_nLevels (std::max<uint32_t> (nLevels, 1)),
+      m_peakRate (site.peakRate),
+      m_table (states.size () * (m_nLevels + 1)),
+      m_state (nCells, 0),
+      m_lowSteps (nCells, 0),
+      m_energy (nCells, 0.0),
+      m_parked (nCells, 0),
+      m_parkedSince (nCells, 0.0),
+      m_nParked (0),
+      m_now (0.0),
+      m_enterThreshold (0.5),
+      m_exitThreshold (0.9),
+      m_holdSteps (10),
+      m_transitions (0),
+      m_controlSteps (0),
+      m_parkedControlSteps (0)
+  {
+    for (size_t s = 0; s < states.size (); s++)
+      {
+        RadioSiteConfig config = site;
+        config.nAntennas = std::max<uint32_t> (site.nAntennas * states[s].antennaFraction, 1);
+        config.bandwidthMHz = site.bandwidthMHz * states[s].bandwidthFraction;
+        RadioPowerModel model (config, m_nLevels);
+        for (uint32_t l = 0; l <= m_nLevels; l++)
+          {
+            double load = static_cast<double> (l) / m_nLevels;
+            m_table[s * (m_nLevels + 1) + l] = model.GetPower (load);
+          }
+      }
+  }
+
+  /**
+   * \param enter fraction of the deeper state's capacity below which a cell
+   * may move deeper
+   * \param exit fraction of the current state's capacity above which a cell
+   * returns to the full state
+   * \param holdSteps consecutive low-load steps required to move deeper
+   */
+  void
+  SetThresholds (double enter, double exit, uint32_t holdSteps)
+  {
+    m_enterThreshold = enter;
+    m_exitThreshold = exit;
+    m_holdSteps = holdSteps;
+  }
+
+  /**
+   * Called with the cell index and its new state on every transition,
+   * e.g. to apply the capacity penalty to the cell's PHY.
+   */
+  void
+  SetStateChangeCallback (Callback<void, uint32_t, uint32_t> cb)
+  {
+    m_onChange = cb;
+  }
+
+  /**
+   * Advance all cells by dt.
+   * \param rate bit rate offered to every cell over the step (bit/s)
+   * \param dt step length (s)
+   */
+  void
+  Step (const double *rate, double dt)
+  {
+    const uint32_t nStates = m_states.size ();
+    const uint32_t rowSize = m_nLevels + 1;
+    m_now += dt;
+    m_controlSteps += m_state.size ();
+    for (size_t i = 0; i < m_state.size (); i++)
+      {
+        if (m_parked[i])
+          {
+            if (rate[i] <= 0)
+              {
+                m_parkedControlSteps++;
+                continue;
+              }
+            Unpark (i, m_now - dt);
+          }
+        uint32_t s = m_state[i];
+        double load = rate[i] / m_peakRate;
+        uint32_t next = s;
+        if (s > 0 && load > m_exitThreshold * m_states[s].capacityFactor)
+          {
+            next = 0;
+          }
+        else if (s + 1 < nStates && load < m_enterThreshold * m_states[s + 1].capacityFactor)
+          {
+            if (++m_lowSteps[i] >= m_holdSteps)
+              {
+                next = s + 1;
+              }
+          }
+        else if (s + 1 == nStates && load <= 0)
+          {
+            if (++m_lowSteps[i] >= m_holdSteps)
+              {
+                Park (i);
+              }
+          }
+        else
+          {
+            m_lowSteps[i] = 0;
+          }
+        if (next != s)
+          {
+            m_state[i] = next;
+            m_lowSteps[i] = 0;
+            m_transitions++;
+            if (!m_onChange.IsNull ())
+              {
+                m_onChange (i, next);
+              }
+          }
+        double stateLoad = std::min (load / m_states[next].capacityFactor, 1.0);
+        uint32_t level = static_cast<uint32_t> (stateLoad * m_nLevels + 0.5);
+        m_energy[i] += m_table[next * rowSize + level] * dt;
+      }
+  }
+
+  /**
+   * Copy the radio energy of every cell since the previous call (J) into
+   * energy and restart the accumulation.  Parked cells are charged up to
+   * now (s, on the clock of the steps), which may run ahead of the last
+   * step while the caller has suspended stepping.
+   */
+  void
+  TakeEnergy (double *energy, double now)
+  {
+    for (size_t i = 0; i < m_state.size (); i++)
+      {
+        if (m_parked[i])
+          {
+            double until = std::max (now, m_parkedSince[i]);
+            m_energy[i] += GetParkedPower () * (until - m_parkedSince[i]);
+            m_parkedSince[i] = until;
+          }
+      }
+    std::copy (m_energy.begin (), m_energy.end (), energy);
+    std::fill (m_energy.begin (), m_energy.end (), 0.0);
+  }
+
+  uint32_t
+  GetState (uint32_t cell) const
+  {
+    return m_state[cell];
+  }
+
+  const PartialSleepState &
+  GetStateInfo (uint32_t state) const
+  {
+    return m_states[state];
+  }
+
+  uint64_t
+  GetTransitions (void) const
+  {
+    return m_transitions;
+  }
+
+  /**
+   * \return whether every cell is parked, so stepping can be suspended
+   */
+  bool
+  AllParked (void) const
+  {
+    return m_nParked == m_state.size ();
+  }
+
+  /**
+   * Account for steps the caller did not run while every cell was parked.
+   * \param dt time skipped (s)
+   * \param steps number of steps skipped
+   */
+  void
+  SkipParked (double dt, uint64_t steps)
+  {
+    m_now += dt;
+    m_controlSteps += steps * m_state.size ();
+    m_parkedControlSteps += steps * m_state.size ();
+  }
+
+  /**
+   * \return the per-cell controller steps run or skipped so far
+   */
+  uint64_t
+  GetControlSteps (void) const
+  {
+    return m_controlSteps;
+  }
+
+  /**
+   * \return the per-cell controller steps skipped so far because the cell
+   * was parked
+   */
+  uint64_t
+  GetParkedControlSteps (void) const
+  {
+    return m_parkedControlSteps;
+  }
+
+private:
+  double
+  GetParkedPower (void) const
+  {
+    return m_table[(m_states.size () - 1) * (m_nLevels + 1)];
+  }
+
+  void
+  Park (size_t i)
+  {
+    m_parked[i] = 1;
+    m_parkedSince[i] = m_now;
+    m_nParked++;
+  }
+
+  /**
+   * Wake a parked cell, charging its idle power until time t.
+   */
+  void
+  Unpark (size_t i, double t)
+  {
+    m_energy[i] += GetParkedPower () * std::max (t - m_parkedSince[i], 0.0);
+    m_parked[i] = 0;
+    m_lowSteps[i] = 0;
+    m_nParked--;
+  }
+
+  std::vector<PartialSleepState> m_states;
+  uint32_t m_nLevels;
+  double m_peakRate;
+  std::vector<double> m_table; //!< power (W) by state, then quantized load
+  std::vector<uint8_t> m_state;
+  std::vector<uint32_t> m_lowSteps;
+  std::vector<double> m_energy;
+  std::vector<uint8_t> m_parked;
+  std::vector<double> m_parkedSince; //!< time the cell was parked or last charged (s)
+  uint32_t m_nParked;
+  double m_now; //!< controller time, the sum of the steps run or skipped (s)
+  double m_enterThreshold;
+  double m_exitThreshold;
+  uint32_t m_holdSteps;
+  uint64_t m_transitions;
+  uint64_t m_controlSteps;
+  uint64_t m_parkedControlSteps;
+  Callback<void, uint32_t, uint32_t> m_onChange;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_PARTIAL_SLEEP_H */
@@ -0,0 +1,313 @@
+#ifndef ORAN_PERF_COUNTERS_H
+#define ORAN_PERF_COUNTERS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ns3 {
+
+/**
+ * Hardware performance counters sampled around named scenario phases.
+ *
+ * A single perf_event_open group (cycles, instructions, cache references,
+ * cache misses, branches, branch misses) is opened for the calling thread
+ * and left running; each PerfCounterScope reads the group once on entry and
+ * once on exit and accumulates the delta under its phase name, so phases
+ * may nest.  Deltas are scaled by time_enabled / time_running when the
+ * kernel multiplexes the group.
+ *
+ * The counters are Linux-only.  When perf_event_open is not available
+ * (other platforms, perf_event_paranoid, containers without CAP_PERFMON)
+ * Enable () returns false and every scope reduces to one predictable
+ * branch on a static flag.
+ */
+class PerfCounters
+{
+public:
+  enum Counter
+  {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    CACHE_REFERENCES,
+    CACHE_MISSES,
+    BRANCHES,
+    BRANCH_MISSES,
+    N_COUNTERS
+  };
+
+  struct Sample
+  {
+    uint64_t value[N_COUNTERS];
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+  };
+
+  struct Totals
+  {
+    uint64_t calls = 0;
+    double value[N_COUNTERS] = {};
+  };
+
+  static PerfCounters &
+  Get (void)
+  {
+    static PerfCounters instance;
+    return instance;
+  }
+
+  static bool
+  IsEnabled (void)
+  {
+    return s_enabled;
+  }
+
+  /**
+   * Open the counter group for the calling thread.
+   * \return true if at least the cycle counter could be opened
+   */
+  bool
+  Enable (void)
+  {
+#ifdef __linux__
+    if (s_enabled)
+      {
+        return true;
+      }
+    static const uint64_t configs[N_COUNTERS] = {
+      PERF_COUNT_HW_CPU_CYCLES,     PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES};
+    m_nOpen = 0;
+    for (int c = 0; c < N_COUNTERS; c++)
+      {
+        struct perf_event_attr attr;
+        std::memset (&attr, 0, sizeof (attr));
+        attr.size = sizeof (attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[c];
+        attr.disabled = (c == CYCLES) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                           | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = static_cast<int> (syscall (__NR_perf_event_open, &attr, 0, -1,
+                                            c == CYCLES ? -1 : m_fd[CYCLES], 0));
+        m_fd[c] = fd;
+        if (fd < 0)
+          {
+            if (c == CYCLES)
+              {
+                m_error = std::strerror (errno);
+                return false;
+              }
+            continue;
+          }
+        m_slot[c] = m_nOpen++;
+      }
+    ioctl (m_fd[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl (m_fd[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    s_enabled = true;
+    return true;
+#else
+    m_error = "perf_event_open is only available on Linux";
+    return false;
+#endif
+  }
+
+  /**
+   * \return why Enable () failed, empty if it did not
+   */
+  std::string
+  GetError (void) const
+  {
+    return m_error;
+  }
+
+  /**
+   * \return true if the given counter is part of the open group
+   */
+  bool
+  IsAvailable (Counter c) const
+  {
+    return s_enabled && m_fd[c] >= 0;
+  }
+
+  void
+  Read (Sample &sample) const
+  {
+    std::memset (&sample, 0, sizeof (sample));
+#ifdef __linux__
+    uint64_t buf[3 + N_COUNTERS];
+    if (read (m_fd[CYCLES], buf, sizeof (buf)) < static_cast<ssize_t> (3 * sizeof (uint64_t)))
+      {
+        return;
+      }
+    sample.timeEnabled = buf[1];
+    sample.timeRunning = buf[2];
+    for (int c = 0; c < N_COUNTERS; c++)
+      {
+        if (m_fd[c] >= 0)
+          {
+            sample.value[c] = buf[3 + m_slot[c]];
+          }
+      }
+#endif
+  }
+
+  void
+  Accumulate (const std::string &phase, const Sample &start, const Sample &end)
+  {
+    Totals &t = m_totals[phase];
+    t.calls++;
+    double running = static_cast<double> (end.timeRunning - start.timeRunning);
+    double enabled = static_cast<double> (end.timeEnabled - start.timeEnabled);
+    double scale = running > 0 ? enabled / running : 1.0;
+    for (int c = 0; c < N_COUNTERS; c++)
+      {
+        t.value[c] += (end.value[c] - start.value[c]) * scale;
+      }
+  }
+
+  /**
+   * Print one line per phase with the raw counts, IPC and miss rates.
+   */
+  void
+  Print (std::ostream &os) const
+  {
+    if (!s_enabled)
+      {
+        return;
+      }
+    os << std::left << std::setw (28) << "phase" << std::right << std::setw (8) << "calls"
+       << std::setw (16) << "cycles" << std::setw (16) << "instructions" << std::setw (8)
+       << "IPC" << std::setw (14) << "cache-miss%" << std::setw (14) << "branch-miss%"
+       << std::endl;
+    for (const auto &entry : m_totals)
+      {
+        const Totals &t = entry.second;
+        os << std::left << std::setw (28) << entry.first << std::right << std::setw (8) << t.calls
+           << std::fixed << std::setprecision (0) << std::setw (16) << t.value[CYCLES]
+           << std::setw (16) << t.value[INSTRUCTIONS] << std::setprecision (2) << std::setw (8)
+           << Ratio (t.value[INSTRUCTIONS], t.value[CYCLES]) << std::setw (14)
+           << Percent (CACHE_MISSES, CACHE_REFERENCES, t) << std::setw (14)
+           << Percent (BRANCH_MISSES, BRANCHES, t) << std::endl;
+      }
+    os.unsetf (std::ios_base::floatfield);
+  }
+
+  const std::map<std::string, Totals> &
+  GetTotals (void) const
+  {
+    return m_totals;
+  }
+
+private:
+  PerfCounters ()
+  {
+    for (int c = 0; c < N_COUNTERS; c++)
+      {
+        m_fd[c] = -1;
+        m_slot[c] = 0;
+      }
+  }
+
+  ~PerfCounters ()
+  {
+#ifdef __linux__
+    for (int c = N_COUNTERS - 1; c >= 0; c--)
+      {
+        if (m_fd[c] >= 0)
+          {
+            close (m_fd[c]);
+          }
+      }
+#endif
+    s_enabled = false;
+  }
+
+  static double
+  Ratio (double num, double den)
+  {
+    return den > 0 ? num / den : 0.0;
+  }
+
+  std::string
+  Percent (Counter num, Counter den, const Totals &t) const
+  {
+    if (!IsAvailable (num) || !IsAvailable (den))
+      {
+        return "n/a";
+      }
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision (2) << 100.0 * Ratio (t.value[num], t.value[den]);
+    return ss.str ();
+  }
+
+  static inline bool s_enabled = false;
+  int m_fd[N_COUNTERS];
+  int m_slot[N_COUNTERS];
+  int m_nOpen = 0;
+  std::string m_error;
+  std::map<std::string, Totals> m_totals;
+};
+
+/**
+ * Accumulates the counter deltas between construction and Stop () (or
+ * destruction) under the given phase name.  Does nothing unless
+ * PerfCounters is enabled.
+ */
+class PerfCounterScope
+{
+public:
+  explicit PerfCounterScope (const char *phase)
+    : m_phase (phase),
+      m_running (PerfCounters::IsEnabled ())
+  {
+    if (m_running)
+      {
+        PerfCounters::Get ().Read (m_start);
+      }
+  }
+
+  ~PerfCounterScope ()
+  {
+    Stop ();
+  }
+
+  void
+  Stop (void)
+  {
+    if (m_running)
+      {
+        PerfCounters::Sample end;
+        PerfCounters::Get ().Read (end);
+        PerfCounters::Get ().Accumulate (m_phase, m_start, end);
+        m_running = false;
+      }
+  }
+
+private:
+  PerfCounterScope (const PerfCounterScope &) = delete;
+  PerfCounterScope &operator= (const PerfCounterScope &) = delete;
+
+  const char *m_phase;
+  bool m_running;
+  PerfCounters::Sample m_start;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_PERF_COUNTERS_H */
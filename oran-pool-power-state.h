@@ -0,0 +1,276 @@
+#ifndef ORAN_POOL_POWER_STATE_H
+#define ORAN_POOL_POWER_STATE_H
+
+#include "oran-timer-wheel.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Wake-up and shutdown costs of an EPM/CPM pool.
+ */
+struct PoolPowerConfig
+{
+  double wakeUpDelay = 20.0;     //!< boot time from off to on (s)
+  double bootPowerFactor = 1.0;  //!< power drawn while booting, relative to the idle power
+  double wakeUpEnergy = 1000.0;  //!< extra energy of every off-to-on transition (J)
+  double shutdownEnergy = 200.0; //!< energy of every on-to-off transition (J)
+  double idleTimeout = 30.0;     //!< time an unloaded pool stays on before shutting down (s)
+};
+
+/**
+ * Off, booting and on states of a set of pools, driven by simulator
+ * timers.
+ *
+ * A pool that is given load while off starts booting, pays the wake-up
+ * energy and serves nothing until the boot timer expires.  A pool left
+ * without load stays on, drawing its idle power, until the idle timer
+ * expires and it shuts down; load given back before that cancels the
+ * timer.  PlanCost () prices a candidate placement against these states
+ * so the optimizer sees wake-up delays, transition energy and idle tails
+ * instead of servers that switch off and on instantly and for free.
+ * The timers are simulator events, or timers of a TimerWheel when one is
+ * set.
+ */
+class PoolPowerStateMachine
+{
+public:
+  enum State : uint8_t
+  {
+    OFF,
+    BOOTING,
+    ON
+  };
+
+  /**
+   * All pools start on and loaded, as in a running deployment.
+   */
+  PoolPowerStateMachine (uint32_t nPools, const PoolPowerConfig &config)
+    : m_config (config),
+      m_state (nPools, ON),
+      m_loaded (nPools, true),
+      m_until (nPools, 0.0),
+      m_since (nPools, 0.0),
+      m_loadedTime (nPools, 0.0),
+      m_idleTime (nPools, 0.0),
+      m_bootTime (nPools, 0.0),
+      m_timer (nPools),
+      m_wheelTimer (nPools),
+      m_wheel (nullptr),
+      m_transitionEnergy (nPools, 0.0),
+      m_wakeUps (0),
+      m_shutdowns (0)
+  {
+  }
+
+  /**
+   * Run the boot and idle timers on a timing wheel instead of as
+   * simulator events; must precede the first SetLoaded ().
+   */
+  void
+  SetTimerWheel (TimerWheel *wheel)
+  {
+    m_wheel = wheel;
+  }
+
+  State
+  GetState (uint32_t pool) const
+  {
+    return static_cast<State> (m_state[pool]);
+  }
+
+  /**
+   * Energy of a pool over the next T seconds if it is given load or not.
+   *
+   * \param loadedPower power of the pool on and serving the candidate load (W)
+   * \param idlePower power of the pool on without load (W)
+   * \param unserved set to the time within T the load waits for a boot (s)
+   */
+  double
+  PlanCost (uint32_t pool, bool loaded, double T, double loadedPower, double idlePower,
+            double &unserved) const
+  {
+    double now = Simulator::Now ().GetSeconds ();
+    unserved = 0.0;
+    switch (m_state[pool])
+      {
+      case ON:
+        if (loaded)
+          {
+            return loadedPower * T;
+          }
+        else
+          {
+            double left = m_loaded[pool] ? m_config.idleTimeout : m_until[pool] - now;
+            return left < T ? idlePower * left + m_config.shutdownEnergy : idlePower * T;
+          }
+      case BOOTING:
+        {
+          double boot = std::min (m_until[pool] - now, T);
+          unserved = loaded ? boot : 0.0;
+          double bootPower = m_config.bootPowerFactor * idlePower;
+          return bootPower * boot + (loaded ? loadedPower : idlePower) * (T - boot);
+        }
+      default:
+        if (!loaded)
+          {
+            return 0.0;
+          }
+        unserved = std::min (m_config.wakeUpDelay, T);
+        return m_config.wakeUpEnergy + m_config.bootPowerFactor * idlePower * unserved
+               + loadedPower * (T - unserved);
+      }
+  }
+
+  /**
+   * Energy of a pool since the previous call, from the time it spent in
+   * every state in between, plus the transition energy it spent.  A boot
+   * or shutdown within the interval splits it at that instant.
+   */
+  double
+  TakeEnergy (uint32_t pool, double loadedPower, double idlePower)
+  {
+    Accrue (pool);
+    double energy = m_transitionEnergy[pool] + loadedPower * m_loadedTime[pool]
+                    + idlePower * m_idleTime[pool]
+                    + m_config.bootPowerFactor * idlePower * m_bootTime[pool];
+    m_transitionEnergy[pool] = 0.0;
+    m_loadedTime[pool] = 0.0;
+    m_idleTime[pool] = 0.0;
+    m_bootTime[pool] = 0.0;
+    return energy;
+  }
+
+  /**
+   * Give a pool load or take it away, starting the boot or idle timers.
+   */
+  void
+  SetLoaded (uint32_t pool, bool loaded)
+  {
+    double now = Simulator::Now ().GetSeconds ();
+    Accrue (pool);
+    bool wasLoaded = m_loaded[pool];
+    m_loaded[pool] = loaded;
+    if (loaded && m_state[pool] == OFF)
+      {
+        m_state[pool] = BOOTING;
+        m_until[pool] = now + m_config.wakeUpDelay;
+        m_transitionEnergy[pool] += m_config.wakeUpEnergy;
+        m_wakeUps++;
+        StartTimer (pool, m_config.wakeUpDelay, &PoolPowerStateMachine::BootDone);
+      }
+    else if (loaded && m_state[pool] == ON && !wasLoaded)
+      {
+        if (m_wheel)
+          {
+            m_wheel->Cancel (m_wheelTimer[pool]);
+          }
+        m_timer[pool].Cancel ();
+      }
+    else if (!loaded && m_state[pool] == ON && wasLoaded)
+      {
+        StartIdleTimer (pool);
+      }
+  }
+
+  uint64_t
+  GetWakeUps (void) const
+  {
+    return m_wakeUps;
+  }
+
+  uint64_t
+  GetShutdowns (void) const
+  {
+    return m_shutdowns;
+  }
+
+private:
+  /**
+   * Count the time since the last state change of a pool in its state.
+   */
+  void
+  Accrue (uint32_t pool)
+  {
+    double now = Simulator::Now ().GetSeconds ();
+    double dt = now - m_since[pool];
+    m_since[pool] = now;
+    switch (m_state[pool])
+      {
+      case ON:
+        (m_loaded[pool] ? m_loadedTime : m_idleTime)[pool] += dt;
+        break;
+      case BOOTING:
+        m_bootTime[pool] += dt;
+        break;
+      default:
+        break;
+      }
+  }
+
+  void
+  StartTimer (uint32_t pool, double delay, void (PoolPowerStateMachine::*expire) (uint32_t))
+  {
+    if (m_wheel)
+      {
+        m_wheelTimer[pool] = m_wheel->Insert (Seconds (delay), MakeCallback (expire, this), pool);
+      }
+    else
+      {
+        m_timer[pool] = Simulator::Schedule (Seconds (delay), expire, this, pool);
+      }
+  }
+
+  void
+  StartIdleTimer (uint32_t pool)
+  {
+    m_until[pool] = Simulator::Now ().GetSeconds () + m_config.idleTimeout;
+    StartTimer (pool, m_config.idleTimeout, &PoolPowerStateMachine::Shutdown);
+  }
+
+  void
+  BootDone (uint32_t pool)
+  {
+    Accrue (pool);
+    m_state[pool] = ON;
+    if (!m_loaded[pool])
+      {
+        StartIdleTimer (pool);
+      }
+  }
+
+  void
+  Shutdown (uint32_t pool)
+  {
+    Accrue (pool);
+    m_state[pool] = OFF;
+    m_transitionEnergy[pool] += m_config.shutdownEnergy;
+    m_shutdowns++;
+  }
+
+  PoolPowerConfig m_config;
+  std::vector<uint8_t> m_state;
+  std::vector<bool> m_loaded;
+  std::vector<double> m_until; //!< end of the running boot or idle timer (s)
+  std::vector<double> m_since; //!< last state change or TakeEnergy () (s)
+  std::vector<double> m_loadedTime; //!< time on with load since the last TakeEnergy () (s)
+  std::vector<double> m_idleTime; //!< time on without load since then (s)
+  std::vector<double> m_bootTime; //!< time booting since then (s)
+  std::vector<EventId> m_timer;
+  std::vector<TimerWheel::Id> m_wheelTimer;
+  TimerWheel *m_wheel; //!< null when the timers are simulator events
+  std::vector<double> m_transitionEnergy; //!< not yet reported by TakeEnergy ()
+  uint64_t m_wakeUps;
+  uint64_t m_shutdowns;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_POOL_POWER_STATE_H */
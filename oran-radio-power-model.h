@@ -0,0 +1,113 @@
+#ifndef ORAN_RADIO_POWER_MODEL_H
+#define ORAN_RADIO_POWER_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Component parameters of a radio site, after the EARTH base station power
+ * model: every transceiver chain has a power amplifier, an RF front end
+ * and baseband processing, and the site pays DC-DC, mains supply and
+ * cooling losses on top.
+ */
+struct RadioSiteConfig
+{
+  uint32_t nSectors;
+  uint32_t nAntennas;      //!< transceiver chains per sector
+  double bandwidthMHz;
+  double maxTxPower;       //!< PA output per chain at full load (W)
+  double paEfficiency;
+  double feederLoss;       //!< fraction of PA output lost before the antenna
+  double rfPower;          //!< RF power per chain at the reference bandwidth (W)
+  double basebandPower;    //!< baseband power per chain at the reference bandwidth (W)
+  double refBandwidthMHz;  //!< bandwidth RF and baseband power are given for
+  double dcLoss;
+  double mainsLoss;
+  double coolingLoss;
+  double peakRate;         //!< cell throughput at full load (bit/s)
+
+  /**
+   * \return a 3-sector, 2x2 MIMO, 20 MHz LTE macro site (EARTH macro figures)
+   */
+  static RadioSiteConfig
+  LteMacro (void)
+  {
+    return {3, 2, 20.0, 20.0, 0.311, 0.5, 12.9, 29.6, 10.0, 0.075, 0.09, 0.10, 150e6};
+  }
+
+  /**
+   * \return a single-sector mmWave small cell with 8 beamforming chains
+   * over 400 MHz, passively cooled and without feeder
+   */
+  static RadioSiteConfig
+  MmWaveSmallCell (void)
+  {
+    return {1, 8, 400.0, 0.5, 0.08, 0.0, 1.5, 4.0, 100.0, 0.09, 0.11, 0.0, 2e9};
+  }
+};
+
+/**
+ * Input power of a radio site against its load, tabulated once at
+ * construction over load levels 0, 1/nLevels, ..., 1 so that GetPower ()
+ * costs a multiply, a round and a table read.
+ */
+class RadioPowerModel
+{
+public:
+  explicit RadioPowerModel (const RadioSiteConfig &config, uint32_t nLevels = 100)
+    : m_config (config),
+      m_nLevels (std::max<uint32_t> (nLevels, 1)),
+      m_table (m_nLevels + 1)
+  {
+    for (uint32_t i = 0; i <= m_nLevels; i++)
+      {
+        m_table[i] = ComputePower (static_cast<double> (i) / m_nLevels);
+      }
+  }
+
+  /**
+   * \param load fraction of the cell's capacity in use, clamped to [0, 1]
+   * \return site input power (W), with the load quantized to the table
+   */
+  double
+  GetPower (double load) const
+  {
+    load = std::min (std::max (load, 0.0), 1.0);
+    return m_table[static_cast<uint32_t> (load * m_nLevels + 0.5)];
+  }
+
+  /**
+   * \return site input power (W) evaluated from the components
+   */
+  double
+  ComputePower (double load) const
+  {
+    const RadioSiteConfig &c = m_config;
+    double bwScale = c.bandwidthMHz / c.refBandwidthMHz;
+    double pa = load * c.maxTxPower / (c.paEfficiency * (1.0 - c.feederLoss));
+    double rf = c.rfPower * bwScale;
+    double bb = c.basebandPower * bwScale;
+    double chains = c.nSectors * c.nAntennas;
+    double losses = (1.0 - c.dcLoss) * (1.0 - c.mainsLoss) * (1.0 - c.coolingLoss);
+    return chains * (pa + rf + bb) / losses;
+  }
+
+  const RadioSiteConfig &
+  GetConfig (void) const
+  {
+    return m_config;
+  }
+
+private:
+  RadioSiteConfig m_config;
+  uint32_t m_nLevels;
+  std::vector<double> m_table;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_RADIO_POWER_MODEL_H */
@@ -0,0 +1,151 @@
+#ifndef ORAN_REALTIME_MONITOR_H
+#define ORAN_REALTIME_MONITOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * Lag of the simulation behind the wall clock under real-time emulation.
+ *
+ * The lag is the wall time elapsed since Start () minus the simulated time
+ * elapsed since then; the real-time simulator keeps it near zero as long
+ * as events run faster than real time.  A control loop misses its deadline
+ * when it finishes more than the deadline after its simulated due time.
+ * Past maxLag the monitor asks for degraded fidelity, and lifts the
+ * request once the lag is back under half of it.
+ */
+class RealtimeMonitor
+{
+public:
+  /**
+   * \param maxLag lag that triggers degraded fidelity (s), 0 to never degrade
+   * \param deadline control loop deadline (s)
+   */
+  RealtimeMonitor (double maxLag, double deadline)
+    : m_maxLag (maxLag),
+      m_deadline (deadline),
+      m_simStart (0.0),
+      m_lag (0.0),
+      m_maxSeen (0.0),
+      m_sum (0.0),
+      m_samples (0),
+      m_loops (0),
+      m_misses (0),
+      m_degraded (false),
+      m_degradations (0)
+  {
+  }
+
+  void
+  Start (double simNow)
+  {
+    m_wallStart = std::chrono::steady_clock::now ();
+    m_simStart = simNow;
+  }
+
+  /**
+   * Measure the lag at simulated time simNow (s).
+   * \return the lag (s)
+   */
+  double
+  Sample (double simNow)
+  {
+    m_lag = Lag (simNow);
+    m_maxSeen = std::max (m_maxSeen, m_lag);
+    m_sum += m_lag;
+    m_samples++;
+    if (m_maxLag > 0 && !m_degraded && m_lag > m_maxLag)
+      {
+        m_degraded = true;
+        m_degradations++;
+      }
+    else if (m_degraded && m_lag < m_maxLag / 2)
+      {
+        m_degraded = false;
+      }
+    return m_lag;
+  }
+
+  /**
+   * Account a control loop due at simulated time due (s) that just ended.
+   * \return whether it missed its deadline
+   */
+  bool
+  EndLoop (double due)
+  {
+    m_loops++;
+    bool missed = Lag (due) > m_deadline;
+    m_misses += missed;
+    return missed;
+  }
+
+  bool
+  IsDegraded (void) const
+  {
+    return m_degraded;
+  }
+
+  double
+  GetLag (void) const
+  {
+    return m_lag;
+  }
+
+  double
+  GetMaxLag (void) const
+  {
+    return m_maxSeen;
+  }
+
+  double
+  GetMeanLag (void) const
+  {
+    return m_samples > 0 ? m_sum / m_samples : 0.0;
+  }
+
+  uint64_t
+  GetLoops (void) const
+  {
+    return m_loops;
+  }
+
+  uint64_t
+  GetMissedDeadlines (void) const
+  {
+    return m_misses;
+  }
+
+  uint64_t
+  GetDegradations (void) const
+  {
+    return m_degradations;
+  }
+
+private:
+  double
+  Lag (double simTime) const
+  {
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now () - m_wallStart;
+    return wall.count () - (simTime - m_simStart);
+  }
+
+  double m_maxLag;
+  double m_deadline;
+  std::chrono::steady_clock::time_point m_wallStart;
+  double m_simStart;
+  double m_lag; //!< at the last sample
+  double m_maxSeen;
+  double m_sum;
+  uint64_t m_samples;
+  uint64_t m_loops;
+  uint64_t m_misses;
+  bool m_degraded;
+  uint64_t m_degradations;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_REALTIME_MONITOR_H */
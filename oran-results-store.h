@@ -0,0 +1,185 @@
+#ifndef ORAN_RESULTS_STORE_H
+#define ORAN_RESULTS_STORE_H
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Append-only store of sweep results shared by parallel runs.
+ *
+ * A store is a directory with
+ *  - "rows": the number of committed rows (uint64_t),
+ *  - "runs.idx": one text line per row, "row<TAB>seed<TAB>run<TAB>k=v,k=v"
+ *    with the scenario parameters sorted by name,
+ *  - "columns/<metric>.f64": one double per row at offset 8 * row, NaN
+ *    for rows that did not report the metric (short files are NaN-padded
+ *    by the reader).
+ *
+ * Append () holds an exclusive flock () on "lock" for the whole append,
+ * so any number of sweep workers (this class or sweep_query.py) can
+ * append concurrently.  The row counter is written last: a worker killed
+ * mid-append leaves the store as it was, and the next append overwrites
+ * its partial row, writing NaN to every existing column it does not
+ * report.  Readers skip index lines at or beyond the committed rows and
+ * keep the last line of a row.  Queries read the index and then only the
+ * column files of the requested metrics.
+ *
+ * The store does not go through TraceWriter, which only streams new
+ * files: an append pwrite ()s single values into existing files and must
+ * have them on disk, in order, before the row counter while it holds the
+ * lock.
+ */
+class ResultsStore
+{
+public:
+  /**
+   * Append one run.
+   * \return false (with errno set) if the store cannot be written
+   */
+  static bool
+  Append (const std::string &dir, const std::map<std::string, std::string> &params,
+          uint64_t seed, uint64_t run, const std::map<std::string, double> &metrics)
+  {
+    mkdir (dir.c_str (), 0755);
+    mkdir ((dir + "/columns").c_str (), 0755);
+    int lockFd = open ((dir + "/lock").c_str (), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0)
+      {
+        return false;
+      }
+    if (flock (lockFd, LOCK_EX) != 0)
+      {
+        close (lockFd);
+        return false;
+      }
+    bool ok = AppendLocked (dir, params, seed, run, metrics);
+    flock (lockFd, LOCK_UN);
+    close (lockFd);
+    return ok;
+  }
+
+  /**
+   * Metric names are used as file names: keep letters, digits, '_', '-'
+   * and '.', replace anything else by '_'.
+   */
+  static std::string
+  SanitizeName (const std::string &name)
+  {
+    std::string out = name;
+    for (char &c : out)
+      {
+        if (!isalnum (static_cast<unsigned char> (c)) && c != '_' && c != '-' && c != '.')
+          {
+            c = '_';
+          }
+      }
+    return out;
+  }
+
+private:
+  static bool
+  AppendLocked (const std::string &dir, const std::map<std::string, std::string> &params,
+                uint64_t seed, uint64_t run, const std::map<std::string, double> &metrics)
+  {
+    int rowsFd = open ((dir + "/rows").c_str (), O_RDWR | O_CREAT, 0644);
+    if (rowsFd < 0)
+      {
+        return false;
+      }
+    uint64_t row = 0;
+    if (pread (rowsFd, &row, sizeof (row), 0) != sizeof (row))
+      {
+        row = 0;
+      }
+
+    std::map<std::string, double> values;
+    for (const auto &m : metrics)
+      {
+        values[SanitizeName (m.first) + ".f64"] = m.second;
+      }
+    // Clear this row in the columns the run does not report, in case a killed append left
+    // values there
+    if (DIR *columns = opendir ((dir + "/columns").c_str ()))
+      {
+        while (struct dirent *entry = readdir (columns))
+          {
+            std::string name = entry->d_name;
+            if (name.size () > 4 && name.compare (name.size () - 4, 4, ".f64") == 0)
+              {
+                values.emplace (name, NAN);
+              }
+          }
+        closedir (columns);
+      }
+    bool ok = true;
+    for (const auto &v : values)
+      {
+        ok = WriteColumn (dir + "/columns/" + v.first, row, v.second) && ok;
+      }
+
+    std::ostringstream line;
+    line << row << "\t" << seed << "\t" << run << "\t";
+    bool first = true;
+    for (const auto &p : params)
+      {
+        line << (first ? "" : ",") << p.first << "=" << p.second;
+        first = false;
+      }
+    line << "\n";
+    std::string text = line.str ();
+    int idxFd = open ((dir + "/runs.idx").c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    ok = ok && idxFd >= 0 && write (idxFd, text.data (), text.size ()) == (ssize_t) text.size ();
+    if (idxFd >= 0)
+      {
+        fsync (idxFd);
+        close (idxFd);
+      }
+
+    if (ok)
+      {
+        row++;
+        ok = pwrite (rowsFd, &row, sizeof (row), 0) == sizeof (row) && fsync (rowsFd) == 0;
+      }
+    close (rowsFd);
+    return ok;
+  }
+
+  static bool
+  WriteColumn (const std::string &path, uint64_t row, double value)
+  {
+    int fd = open (path.c_str (), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+      {
+        return false;
+      }
+    struct stat st;
+    fstat (fd, &st);
+    uint64_t have = st.st_size / sizeof (double);
+    if (have < row)
+      {
+        std::vector<double> pad (row - have, NAN);
+        pwrite (fd, pad.data (), pad.size () * sizeof (double), have * sizeof (double));
+      }
+    bool ok = pwrite (fd, &value, sizeof (value), row * sizeof (double)) == sizeof (value);
+    ok = fsync (fd) == 0 && ok;
+    close (fd);
+    return ok;
+  }
+};
+
+} // namespace ns3
+
+#endif /* ORAN_RESULTS_STORE_H */
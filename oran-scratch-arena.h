@@ -0,0 +1,159 @@
+#ifndef ORAN_SCRATCH_ARENA_H
+#define ORAN_SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Heap resource that counts the blocks it hands out, used as the upstream
+ * of ScratchArena so that every real heap allocation is visible.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  uint64_t m_allocations = 0;
+  uint64_t m_bytes = 0;
+
+private:
+  void *
+  do_allocate (std::size_t bytes, std::size_t alignment) override
+  {
+    m_allocations++;
+    m_bytes += bytes;
+    return std::pmr::new_delete_resource ()->allocate (bytes, alignment);
+  }
+
+  void
+  do_deallocate (void *p, std::size_t bytes, std::size_t alignment) override
+  {
+    std::pmr::new_delete_resource ()->deallocate (p, bytes, alignment);
+  }
+
+  bool
+  do_is_equal (const std::pmr::memory_resource &other) const noexcept override
+  {
+    return this == &other;
+  }
+};
+
+/**
+ * Monotonic arena for scratch memory that lives for one optimizer
+ * invocation or one energy sampling tick.
+ *
+ * Containers take it as their std::pmr allocator; deallocation is a no-op
+ * and Reset () drops everything at once.  The arena keeps its initial
+ * block sized to the largest interval seen so far, so after the first few
+ * intervals Reset () hands back a block that already fits and no heap
+ * allocation happens at all.
+ */
+class ScratchArena : public std::pmr::memory_resource
+{
+public:
+  explicit ScratchArena (std::size_t initialBytes = 64 * 1024)
+    : m_block (initialBytes),
+      m_resource (new std::pmr::monotonic_buffer_resource (m_block.data (), m_block.size (),
+                                                           &m_upstream))
+  {
+  }
+
+  /**
+   * Release all scratch memory.  Must only be called once no container
+   * allocated from the arena is used any more.
+   */
+  void
+  Reset (void)
+  {
+    m_resets++;
+    if (m_intervalBytes > m_block.size ())
+      {
+        // Grow the initial block to the high-water mark of this interval
+        m_resource.reset ();
+        m_block.assign (m_intervalBytes + m_intervalBytes / 4, std::byte (0));
+        m_resource.reset (new std::pmr::monotonic_buffer_resource (m_block.data (),
+                                                                   m_block.size (), &m_upstream));
+      }
+    else
+      {
+        m_resource->release ();
+      }
+    m_intervalBytes = 0;
+  }
+
+  /**
+   * \return allocations served from the arena
+   */
+  uint64_t
+  GetAllocations (void) const
+  {
+    return m_allocations;
+  }
+
+  /**
+   * \return allocations that the arena had to forward to the heap
+   */
+  uint64_t
+  GetHeapAllocations (void) const
+  {
+    return m_upstream.m_allocations;
+  }
+
+  /**
+   * \return heap allocations avoided by serving scratch from the arena
+   */
+  uint64_t
+  GetAllocationsAvoided (void) const
+  {
+    return m_allocations - m_upstream.m_allocations;
+  }
+
+  void
+  Print (std::ostream &os) const
+  {
+    os << "Scratch arena: " << m_allocations << " allocations (" << m_bytes << " bytes) over "
+       << m_resets << " intervals, " << m_upstream.m_allocations << " heap allocations, "
+       << GetAllocationsAvoided () << " avoided, block " << m_block.size () << " bytes"
+       << std::endl;
+  }
+
+private:
+  void *
+  do_allocate (std::size_t bytes, std::size_t alignment) override
+  {
+    m_allocations++;
+    m_bytes += bytes;
+    m_intervalBytes += bytes + alignment;
+    return m_resource->allocate (bytes, alignment);
+  }
+
+  void
+  do_deallocate (void *, std::size_t, std::size_t) override
+  {
+  }
+
+  bool
+  do_is_equal (const std::pmr::memory_resource &other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  ScratchArena (const ScratchArena &) = delete;
+  ScratchArena &operator= (const ScratchArena &) = delete;
+
+  CountingResource m_upstream;
+  std::vector<std::byte> m_block;
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> m_resource;
+  uint64_t m_allocations = 0;
+  uint64_t m_bytes = 0;
+  uint64_t m_resets = 0;
+  std::size_t m_intervalBytes = 0;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_SCRATCH_ARENA_H */
@@ -0,0 +1,318 @@
+#ifndef ORAN_SERVER_MODEL_H
+#define ORAN_SERVER_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * A DVFS operating point of a core.
+ */
+struct DvfsLevel
+{
+  double frequency; //!< fraction of the nominal frequency, and of the core capacity
+  double power;     //!< power of a busy core at this level (W)
+};
+
+/**
+ * Power and capacity of a multi-core EPM/CPM server.
+ */
+struct ServerConfig
+{
+  uint32_t nCores;
+  double coreCapacity;  //!< load a core serves at nominal frequency
+  double uncorePower;   //!< chassis, memory and NICs of a powered server (W)
+  double idlePower;     //!< core in shallow idle (W)
+  double sleepPower;    //!< core in deep sleep (W)
+  uint32_t spareCores;  //!< unloaded cores kept in shallow idle for new load
+  std::vector<DvfsLevel> dvfs; //!< in increasing frequency, the last one nominal
+
+  /**
+   * Split the static/dynamic power of a single-capacity pool over nCores
+   * cores: 60% of the static power is uncore, the rest the idle power of
+   * the cores, and the dynamic power at full load is spread over the cores
+   * with a cubic frequency dependence across three DVFS levels.
+   */
+  static ServerConfig
+  ForPool (double capacity, double staticPower, double dynamicPower, uint32_t nCores)
+  {
+    ServerConfig c;
+    c.nCores = std::max<uint32_t> (nCores, 1);
+    c.coreCapacity = capacity / c.nCores;
+    c.uncorePower = 0.6 * staticPower;
+    c.idlePower = 0.4 * staticPower / c.nCores;
+    c.sleepPower = 0.1 * c.idlePower;
+    c.spareCores = 1;
+    for (double f : {0.5, 0.75, 1.0})
+      {
+        c.dvfs.push_back ({f, c.idlePower + dynamicPower / c.nCores * f * f * f});
+      }
+    return c;
+  }
+};
+
+/**
+ * A multi-core server onto whose cores DU or CU workloads are packed.
+ *
+ * Core states are bitmasks, one bit per core in 64-bit words: one mask for
+ * shallow idle, one for deep sleep and one per DVFS level for busy cores.
+ * The power of the server is the uncore power plus, for every mask, its
+ * population count times the power of that state, so GetPower () costs
+ * O(cores / 64) per state.  A server with no load is powered off.
+ */
+class MultiCoreServer
+{
+public:
+  explicit MultiCoreServer (const ServerConfig &config)
+    : m_config (config),
+      m_words ((config.nCores + 63) / 64),
+      m_idle (m_words, 0),
+      m_sleep (m_words, 0),
+      m_level (config.dvfs.size (), std::vector<uint64_t> (m_words, 0)),
+      m_on (false)
+  {
+  }
+
+  /**
+   * Pack the workloads first-fit decreasing onto cores: a workload larger
+   * than a core takes whole cores for its integer part.  Each busy core
+   * then runs at the lowest DVFS level that serves its load, the first
+   * spareCores unloaded cores idle and the others sleep.
+   *
+   * Only the loads of the busy cores are kept, as scratch: the core masks
+   * do not change until Commit (), so a search can plan any number of
+   * packings in O(busy cores) each.
+   *
+   * \param overload set to the load that does not fit on the cores
+   * \return the power of the server in the planned state (W)
+   */
+  double
+  Plan (const double *loads, size_t n, double &overload)
+  {
+    const double cap = m_config.coreCapacity;
+    m_coreLoad.clear ();
+    m_items.assign (loads, loads + n);
+    std::sort (m_items.begin (), m_items.end (), std::greater<double> ());
+    overload = 0.0;
+    for (double item : m_items)
+      {
+        while (item > cap && m_coreLoad.size () < m_config.nCores)
+          {
+            m_coreLoad.push_back (cap);
+            item -= cap;
+          }
+        if (item <= 0)
+          {
+            continue;
+          }
+        uint32_t used = m_coreLoad.size ();
+        uint32_t core = 0;
+        while (core < used && m_coreLoad[core] + item > cap)
+          {
+            core++;
+          }
+        if (core == used && used < m_config.nCores)
+          {
+            m_coreLoad.push_back (0.0);
+          }
+        else if (core == used)
+          {
+            // No room left: every core is busy, put it on the least loaded one
+            auto least = std::min_element (m_coreLoad.begin (), m_coreLoad.end ());
+            core = least - m_coreLoad.begin ();
+          }
+        m_coreLoad[core] += item;
+      }
+
+    uint32_t used = m_coreLoad.size ();
+    if (used == 0)
+      {
+        return 0.0;
+      }
+    uint32_t spare = std::min (m_config.spareCores, m_config.nCores - used);
+    double power = m_config.uncorePower + spare * m_config.idlePower
+                   + (m_config.nCores - used - spare) * m_config.sleepPower;
+    for (double load : m_coreLoad)
+      {
+        power += m_config.dvfs[Level (load)].power;
+        overload += std::max (load - cap, 0.0);
+      }
+    return power;
+  }
+
+  /**
+   * Put the cores in the state of the last Plan (), in O(busy cores +
+   * cores / 64): the idle and sleeping cores are runs filled a word at a
+   * time.
+   */
+  void
+  Commit (void)
+  {
+    ClearMasks ();
+    uint32_t used = m_coreLoad.size ();
+    m_on = used > 0;
+    if (!m_on)
+      {
+        return;
+      }
+    for (uint32_t core = 0; core < used; core++)
+      {
+        SetBit (m_level[Level (m_coreLoad[core])], core);
+      }
+    uint32_t spareEnd = used + std::min (m_config.spareCores, m_config.nCores - used);
+    SetRange (m_idle, used, spareEnd);
+    SetRange (m_sleep, spareEnd, m_config.nCores);
+  }
+
+  /**
+   * Plan () the workloads and Commit () the result.
+   * \return the power of the server in the resulting state (W)
+   */
+  double
+  Pack (const double *loads, size_t n, double &overload)
+  {
+    Plan (loads, n, overload);
+    Commit ();
+    return GetPower ();
+  }
+
+  /**
+   * \return the power of the server in its current state (W)
+   */
+  double
+  GetPower (void) const
+  {
+    if (!m_on)
+      {
+        return 0.0;
+      }
+    double power = m_config.uncorePower + Count (m_idle) * m_config.idlePower
+                   + Count (m_sleep) * m_config.sleepPower;
+    for (size_t l = 0; l < m_level.size (); l++)
+      {
+        power += Count (m_level[l]) * m_config.dvfs[l].power;
+      }
+    return power;
+  }
+
+  /**
+   * \return the power of the server powered on without load (W)
+   */
+  double
+  GetIdlePower (void) const
+  {
+    uint32_t spare = std::min (m_config.spareCores, m_config.nCores);
+    return m_config.uncorePower + spare * m_config.idlePower
+           + (m_config.nCores - spare) * m_config.sleepPower;
+  }
+
+  uint32_t
+  GetBusyCores (void) const
+  {
+    uint32_t busy = 0;
+    for (const std::vector<uint64_t> &mask : m_level)
+      {
+        busy += Count (mask);
+      }
+    return busy;
+  }
+
+  uint32_t
+  GetSleepingCores (void) const
+  {
+    return Count (m_sleep);
+  }
+
+  bool
+  IsOn (void) const
+  {
+    return m_on;
+  }
+
+private:
+  /**
+   * \return the lowest DVFS level that serves load, or the nominal one
+   */
+  uint32_t
+  Level (double load) const
+  {
+    const uint32_t top = m_config.dvfs.size () - 1;
+    uint32_t l = 0;
+    while (l < top && m_config.dvfs[l].frequency * m_config.coreCapacity < load)
+      {
+        l++;
+      }
+    return l;
+  }
+
+  void
+  ClearMasks (void)
+  {
+    std::fill (m_idle.begin (), m_idle.end (), 0);
+    std::fill (m_sleep.begin (), m_sleep.end (), 0);
+    for (std::vector<uint64_t> &mask : m_level)
+      {
+        std::fill (mask.begin (), mask.end (), 0);
+      }
+  }
+
+  static void
+  SetBit (std::vector<uint64_t> &mask, uint32_t core)
+  {
+    mask[core / 64] |= uint64_t (1) << (core % 64);
+  }
+
+  /**
+   * Set the bits of cores [begin, end) of mask: whole words at once, and
+   * the partial first and last words through masks.
+   */
+  static void
+  SetRange (std::vector<uint64_t> &mask, uint32_t begin, uint32_t end)
+  {
+    if (begin >= end)
+      {
+        return;
+      }
+    uint32_t first = begin / 64;
+    uint32_t last = (end - 1) / 64;
+    uint64_t head = ~uint64_t (0) << (begin % 64);
+    uint64_t tail = ~uint64_t (0) >> (63 - (end - 1) % 64);
+    if (first == last)
+      {
+        mask[first] |= head & tail;
+        return;
+      }
+    mask[first] |= head;
+    std::fill (mask.begin () + first + 1, mask.begin () + last, ~uint64_t (0));
+    mask[last] |= tail;
+  }
+
+  static uint32_t
+  Count (const std::vector<uint64_t> &mask)
+  {
+    uint32_t n = 0;
+    for (uint64_t w : mask)
+      {
+        n += __builtin_popcountll (w);
+      }
+    return n;
+  }
+
+  ServerConfig m_config;
+  uint32_t m_words;
+  std::vector<uint64_t> m_idle;
+  std::vector<uint64_t> m_sleep;
+  std::vector<std::vector<uint64_t>> m_level; //!< busy cores per DVFS level
+  std::vector<double> m_coreLoad; //!< load of every busy core of the last Plan ()
+  std::vector<double> m_items; //!< sorted workloads, kept to reuse its storage
+  bool m_on;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_SERVER_MODEL_H */
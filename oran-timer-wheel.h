@@ -0,0 +1,398 @@
+#ifndef ORAN_TIMER_WHEEL_H
+#define ORAN_TIMER_WHEEL_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Hierarchical timing wheel for coarse protocol timers.
+ *
+ * Time is cut into ticks; a timer expires at the first tick at or after
+ * its due time.  Level 0 has one slot per tick for the next SLOTS ticks,
+ * and every level above covers SLOTS times the span of the one below;
+ * timers move down a level when the wheel reaches their slot.  Every slot
+ * is an intrusive doubly-linked list over a pool of timer records, so
+ * Insert () and Cancel () are O(1) and allocate nothing once the pool has
+ * grown.
+ *
+ * One simulator event drives the wheel, and only while timers are
+ * pending: it fires at the earliest tick with a timer in level 0 or at
+ * which a higher level moves timers down out of a non-empty slot, and
+ * skips the ticks in between, which have nothing to do.
+ */
+class TimerWheel
+{
+public:
+  typedef Callback<void, uint32_t> Handler; //!< called with the argument given to Insert ()
+
+  /**
+   * Handle of an inserted timer, stale once the timer expired or was
+   * cancelled.
+   */
+  struct Id
+  {
+    uint32_t index = NIL;
+    uint32_t generation = 0;
+  };
+
+  static constexpr uint32_t BITS = 6;
+  static constexpr uint32_t SLOTS = 1u << BITS;
+  static constexpr uint32_t LEVELS = 4;
+
+  explicit TimerWheel (Time tick)
+    : m_tick (tick.GetTimeStep ()),
+      m_next (0),
+      m_slots (LEVELS * SLOTS + 1, NIL),
+      m_free (NIL),
+      m_pending (0),
+      m_count {},
+      m_inserted (0),
+      m_cancelled (0),
+      m_expired (0),
+      m_events (0)
+  {
+  }
+
+  ~TimerWheel ()
+  {
+    m_event.Cancel ();
+  }
+
+  /**
+   * Call handler (arg) after delay, rounded up to a whole tick.
+   */
+  Id
+  Insert (Time delay, Handler handler, uint32_t arg)
+  {
+    int64_t now = Simulator::Now ().GetTimeStep ();
+    if (m_pending == 0)
+      {
+        // Idle wheel: every slot is empty, so the tick counter can jump to now
+        m_next = std::max<uint64_t> (m_next, now / m_tick);
+      }
+    uint64_t due = (now + delay.GetTimeStep () + m_tick - 1) / m_tick;
+    uint32_t t = m_free;
+    if (t == NIL)
+      {
+        t = m_timers.size ();
+        m_timers.emplace_back ();
+      }
+    else
+      {
+        m_free = m_timers[t].next;
+      }
+    Timer &timer = m_timers[t];
+    timer.due = std::max (due, m_next);
+    timer.handler = handler;
+    timer.arg = arg;
+    Link (t);
+    m_pending++;
+    m_inserted++;
+    ScheduleTick ();
+    return Id {t, timer.generation};
+  }
+
+  /**
+   * Stop a timer; does nothing if it expired or was cancelled already.
+   */
+  void
+  Cancel (const Id &id)
+  {
+    if (!IsRunning (id))
+      {
+        return;
+      }
+    Unlink (id.index);
+    Release (id.index);
+    m_cancelled++;
+    if (m_pending == 0)
+      {
+        m_event.Cancel ();
+      }
+  }
+
+  bool
+  IsRunning (const Id &id) const
+  {
+    return id.index < m_timers.size () && m_timers[id.index].generation == id.generation
+           && m_timers[id.index].slot != NIL;
+  }
+
+  uint32_t
+  GetPending (void) const
+  {
+    return m_pending;
+  }
+
+  uint64_t
+  GetInserted (void) const
+  {
+    return m_inserted;
+  }
+
+  uint64_t
+  GetCancelled (void) const
+  {
+    return m_cancelled;
+  }
+
+  uint64_t
+  GetExpired (void) const
+  {
+    return m_expired;
+  }
+
+  /**
+   * \return simulator events the wheel ran
+   */
+  uint64_t
+  GetEvents (void) const
+  {
+    return m_events;
+  }
+
+  /**
+   * \return simulator events saved: one per timer, less those the wheel
+   * ran, or 0 when it ran more events than timers were inserted
+   */
+  uint64_t
+  GetEventsRemoved (void) const
+  {
+    return m_inserted > m_events ? m_inserted - m_events : 0;
+  }
+
+private:
+  static constexpr uint32_t NIL = 0xFFFFFFFF;
+  static constexpr uint32_t EXPIRING = LEVELS * SLOTS; //!< list of the timers being run
+
+  struct Timer
+  {
+    uint64_t due = 0; //!< tick
+    uint32_t prev = NIL;
+    uint32_t next = NIL; //!< also links the free list
+    uint32_t slot = NIL; //!< NIL when not in the wheel
+    uint32_t generation = 0;
+    uint32_t arg = 0;
+    Handler handler;
+  };
+
+  /**
+   * Put a timer in the slot of its due tick, relative to the next tick to
+   * run.
+   */
+  void
+  Link (uint32_t t)
+  {
+    Timer &timer = m_timers[t];
+    uint64_t delta = timer.due - m_next;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t (1) << (BITS * (level + 1))))
+      {
+        level++;
+      }
+    // Beyond the top level: park in its farthest slot and re-file on the way down
+    uint64_t due = std::min (timer.due, m_next + (uint64_t (1) << (BITS * LEVELS)) - 1);
+    uint32_t slot = level * SLOTS + ((due >> (BITS * level)) & (SLOTS - 1));
+    timer.slot = slot;
+    timer.prev = NIL;
+    timer.next = m_slots[slot];
+    if (timer.next != NIL)
+      {
+        m_timers[timer.next].prev = t;
+      }
+    m_slots[slot] = t;
+    m_count[level]++;
+  }
+
+  void
+  Unlink (uint32_t t)
+  {
+    Timer &timer = m_timers[t];
+    if (timer.prev != NIL)
+      {
+        m_timers[timer.prev].next = timer.next;
+      }
+    else
+      {
+        m_slots[timer.slot] = timer.next;
+      }
+    if (timer.next != NIL)
+      {
+        m_timers[timer.next].prev = timer.prev;
+      }
+    m_count[timer.slot / SLOTS]--;
+    timer.slot = NIL;
+  }
+
+  void
+  Release (uint32_t t)
+  {
+    Timer &timer = m_timers[t];
+    timer.generation++;
+    timer.handler = Handler ();
+    timer.next = m_free;
+    m_free = t;
+    m_pending--;
+  }
+
+  /**
+   * Take every timer out of a slot and file it again from the next tick.
+   */
+  void
+  Cascade (uint32_t slot)
+  {
+    uint32_t t = m_slots[slot];
+    while (t != NIL)
+      {
+        uint32_t next = m_timers[t].next;
+        Unlink (t);
+        Link (t);
+        t = next;
+      }
+  }
+
+  /**
+   * Run the next tick: move timers down from the levels whose slot it
+   * reaches, then expire the timers of its level-0 slot.
+   */
+  void
+  RunTick (void)
+  {
+    uint64_t tick = m_next;
+    for (uint32_t level = 1; level < LEVELS; level++)
+      {
+        if ((tick >> (BITS * (level - 1))) & (SLOTS - 1))
+          {
+            break;
+          }
+        Cascade (level * SLOTS + ((tick >> (BITS * level)) & (SLOTS - 1)));
+      }
+    m_next = tick + 1;
+    // Detach the slot first: handlers may insert timers due a whole turn from now into it
+    uint32_t slot = tick & (SLOTS - 1);
+    for (uint32_t t = m_slots[slot]; t != NIL; t = m_timers[t].next)
+      {
+        m_timers[t].slot = EXPIRING;
+        m_count[0]--;
+        m_count[LEVELS]++;
+      }
+    m_slots[EXPIRING] = m_slots[slot];
+    m_slots[slot] = NIL;
+    while (m_slots[EXPIRING] != NIL)
+      {
+        uint32_t t = m_slots[EXPIRING];
+        Unlink (t);
+        Handler handler = m_timers[t].handler;
+        uint32_t arg = m_timers[t].arg;
+        Release (t);
+        m_expired++;
+        handler (arg);
+      }
+  }
+
+  void
+  Tick (void)
+  {
+    m_events++;
+    uint64_t now = Simulator::Now ().GetTimeStep () / m_tick;
+    while (m_pending > 0)
+      {
+        uint64_t next = NextTick ();
+        if (next > now)
+          {
+            break;
+          }
+        m_next = next;
+        RunTick ();
+      }
+    ScheduleTick ();
+  }
+
+  /**
+   * \return the earliest tick from the next one that expires timers or
+   * moves timers down from a higher level; the wheel must not be empty
+   */
+  uint64_t
+  NextTick (void) const
+  {
+    // Every level-0 timer is due within a turn of the next tick
+    uint64_t next = UINT64_MAX;
+    if (m_count[0] > 0)
+      {
+        next = m_next;
+        while (m_slots[next & (SLOTS - 1)] == NIL)
+          {
+            next++;
+          }
+      }
+    // A level reaches one slot per span of the level below: the first
+    // non-empty slot from its position is reached within a turn
+    for (uint32_t level = 1; level < LEVELS; level++)
+      {
+        if (m_count[level] == 0)
+          {
+            continue;
+          }
+        uint32_t shift = BITS * level;
+        uint64_t first = (m_next + (uint64_t (1) << shift) - 1) >> shift;
+        for (uint64_t k = first; k < first + SLOTS && (k << shift) < next; k++)
+          {
+            if (m_slots[level * SLOTS + (k & (SLOTS - 1))] != NIL)
+              {
+                next = k << shift;
+                break;
+              }
+          }
+      }
+    return next;
+  }
+
+  /**
+   * Schedule the wheel's event at the next tick with work, if any.
+   */
+  void
+  ScheduleTick (void)
+  {
+    if (m_pending == 0)
+      {
+        m_event.Cancel ();
+        return;
+      }
+    uint64_t next = NextTick ();
+    Time now = Simulator::Now ();
+    Time at = TimeStep (std::max<int64_t> (next * m_tick, now.GetTimeStep ()));
+    if (m_event.IsRunning () && m_at == at)
+      {
+        return;
+      }
+    m_event.Cancel ();
+    m_at = at;
+    m_event = Simulator::Schedule (at - now, &TimerWheel::Tick, this);
+  }
+
+  int64_t m_tick; //!< tick length, in simulator time steps
+  uint64_t m_next; //!< next tick to run
+  std::vector<uint32_t> m_slots; //!< first timer of every slot, level by level
+  std::vector<Timer> m_timers;
+  uint32_t m_free; //!< first free timer record
+  uint32_t m_pending;
+  uint32_t m_count[LEVELS + 1]; //!< timers in every level, then in the expiring list
+  EventId m_event;
+  Time m_at; //!< time of m_event
+  uint64_t m_inserted;
+  uint64_t m_cancelled;
+  uint64_t m_expired;
+  uint64_t m_events;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_TIMER_WHEEL_H */
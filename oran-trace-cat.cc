@@ -0,0 +1,78 @@
+#include "ns3/core-module.h"
+#include "oran-trace-compression.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * Prints the records of a compressed scenario trace (--compressTraces)
+ * whose time, the first column, lies in [from, to].  Only the chunks
+ * overlapping the range are read, and they are decompressed in parallel.
+ */
+
+NS_LOG_COMPONENT_DEFINE ("OranTraceCat");
+
+int
+main (int argc, char *argv[])
+{
+  std::string file = "";
+  double from = 0.0;
+  double to = 1e300;
+  uint32_t threads = 0;
+  bool index = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("file", "Compressed trace file", file);
+  cmd.AddValue ("from", "Earliest record time in seconds", from);
+  cmd.AddValue ("to", "Latest record time in seconds", to);
+  cmd.AddValue ("threads", "Decompression threads, 0 for one per core", threads);
+  cmd.AddValue ("index", "Print the chunk index instead of the records", index);
+  cmd.Parse (argc, argv);
+
+  CompressedTraceReader reader;
+  if (!reader.Open (file))
+    {
+      NS_LOG_ERROR ("Can't open compressed trace " << file);
+      return 1;
+    }
+
+  if (index)
+    {
+      for (const auto &e : reader.GetIndex ())
+        {
+          std::cout << e.offset << "\t" << e.rawSize << "\t" << e.compressedSize << "\t" << e.tMin
+                    << "\t" << e.tMax << std::endl;
+        }
+      return 0;
+    }
+
+  std::string records;
+  if (!reader.ReadRange (from, to, records, threads))
+    {
+      NS_LOG_ERROR ("Corrupt chunk in " << file);
+      return 1;
+    }
+  size_t start = 0;
+  while (start < records.size ())
+    {
+      size_t end = records.find ('\n', start);
+      end = (end == std::string::npos) ? records.size () : end + 1;
+      const char *line = records.c_str () + start;
+      if (*line == '#')
+        {
+          std::cout.write (line, end - start);
+        }
+      else
+        {
+          double t = std::strtod (line, nullptr);
+          if (t >= from && t <= to)
+            {
+              std::cout.write (line, end - start);
+            }
+        }
+      start = end;
+    }
+  return 0;
+}
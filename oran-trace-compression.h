@@ -0,0 +1,392 @@
+#ifndef ORAN_TRACE_COMPRESSION_H
+#define ORAN_TRACE_COMPRESSION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Byte-oriented LZ77 block codec in the style of LZ4.
+ *
+ * A block is a sequence of (literals, match) pairs.  Each pair starts with
+ * a token whose high nibble is the literal count and low nibble the match
+ * length minus 4, with 15 meaning "more length bytes follow" (each adding
+ * up to 255).  The literals follow, then a 16-bit little-endian match
+ * offset and the extra match length bytes.  The last pair has literals
+ * only.  Matches are found through a single-entry hash table of 4-byte
+ * sequences over a 64 KiB window, which keeps compression at a few hundred
+ * MB/s on text traces.
+ */
+class LzCodec
+{
+public:
+  static const uint32_t MIN_MATCH = 4;
+  static const uint32_t MAX_OFFSET = 65535;
+
+  /**
+   * \return an upper bound of the compressed size of n bytes
+   */
+  static size_t
+  Bound (size_t n)
+  {
+    return n + n / 255 + 16;
+  }
+
+  /**
+   * Compress n bytes of src into out (resized to the compressed size).
+   */
+  static void
+  Compress (const uint8_t *src, size_t n, std::vector<uint8_t> &out)
+  {
+    static const int HASH_BITS = 14;
+    std::vector<uint32_t> table (1 << HASH_BITS, UINT32_MAX);
+    out.resize (Bound (n));
+    uint8_t *op = out.data ();
+    size_t ip = 0;
+    size_t anchor = 0;
+    // Leave the tail as literals so that 4-byte reads never overrun
+    size_t limit = n > 12 ? n - 12 : 0;
+    uint32_t misses = 0;
+    while (ip < limit)
+      {
+        uint32_t seq = Read32 (src + ip);
+        uint32_t h = (seq * 2654435761u) >> (32 - HASH_BITS);
+        uint32_t ref = table[h];
+        table[h] = static_cast<uint32_t> (ip);
+        if (ref == UINT32_MAX || ip - ref > MAX_OFFSET || Read32 (src + ref) != seq)
+          {
+            // Skip faster through incompressible data
+            ip += 1 + (misses++ >> 5);
+            continue;
+          }
+        misses = 0;
+        size_t len = MIN_MATCH;
+        while (ip + len < n && src[ref + len] == src[ip + len])
+          {
+            len++;
+          }
+        op = WriteSequence (op, src + anchor, ip - anchor, static_cast<uint32_t> (ip - ref), len);
+        ip += len;
+        anchor = ip;
+      }
+    op = WriteSequence (op, src + anchor, n - anchor, 0, 0);
+    out.resize (op - out.data ());
+  }
+
+  /**
+   * Decompress a block into dst, which must hold exactly rawSize bytes.
+   * \return false if the block is corrupt
+   */
+  static bool
+  Decompress (const uint8_t *src, size_t n, uint8_t *dst, size_t rawSize)
+  {
+    const uint8_t *ip = src;
+    const uint8_t *end = src + n;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + rawSize;
+    while (ip < end)
+      {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !ReadLength (ip, end, lit))
+          {
+            return false;
+          }
+        if (static_cast<size_t> (end - ip) < lit || static_cast<size_t> (oend - op) < lit)
+          {
+            return false;
+          }
+        std::memcpy (op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end)
+          {
+            break;
+          }
+        if (end - ip < 2)
+          {
+            return false;
+          }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !ReadLength (ip, end, len))
+          {
+            return false;
+          }
+        len += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t> (op - dst)
+            || static_cast<size_t> (oend - op) < len)
+          {
+            return false;
+          }
+        const uint8_t *match = op - offset;
+        for (size_t i = 0; i < len; i++)
+          {
+            op[i] = match[i];
+          }
+        op += len;
+      }
+    return op == oend;
+  }
+
+private:
+  static uint32_t
+  Read32 (const uint8_t *p)
+  {
+    uint32_t v;
+    std::memcpy (&v, p, sizeof (v));
+    return v;
+  }
+
+  static uint8_t *
+  WriteLength (uint8_t *op, size_t len)
+  {
+    while (len >= 255)
+      {
+        *op++ = 255;
+        len -= 255;
+      }
+    *op++ = static_cast<uint8_t> (len);
+    return op;
+  }
+
+  static bool
+  ReadLength (const uint8_t *&ip, const uint8_t *end, size_t &len)
+  {
+    uint8_t b;
+    do
+      {
+        if (ip == end)
+          {
+            return false;
+          }
+        b = *ip++;
+        len += b;
+      }
+    while (b == 255);
+    return true;
+  }
+
+  static uint8_t *
+  WriteSequence (uint8_t *op, const uint8_t *lit, size_t nLit, uint32_t offset, size_t matchLen)
+  {
+    size_t m = matchLen ? matchLen - MIN_MATCH : 0;
+    *op++ = static_cast<uint8_t> ((std::min<size_t> (nLit, 15) << 4) | std::min<size_t> (m, 15));
+    if (nLit >= 15)
+      {
+        op = WriteLength (op, nLit - 15);
+      }
+    std::memcpy (op, lit, nLit);
+    op += nLit;
+    if (matchLen)
+      {
+        *op++ = offset & 0xff;
+        *op++ = offset >> 8;
+        if (m >= 15)
+          {
+            op = WriteLength (op, m - 15);
+          }
+      }
+    return op;
+  }
+};
+
+/**
+ * Layout of compressed trace files.
+ *
+ * The file starts with MAGIC and is followed by chunks, each being a
+ * ChunkHeader and the LzCodec block of a run of whole trace records.  The
+ * file ends with the chunk index (one IndexEntry per chunk), the number of
+ * chunks as a uint64_t and INDEX_MAGIC, so a reader finds the index from
+ * the end of the file and seeks straight to the chunks of a time range.
+ */
+struct CompressedTraceFormat
+{
+  static constexpr char MAGIC[8] = {'O', 'R', 'A', 'N', 'T', 'R', 'Z', '1'};
+  static constexpr char INDEX_MAGIC[8] = {'O', 'R', 'A', 'N', 'I', 'D', 'X', '1'};
+
+  struct ChunkHeader
+  {
+    uint32_t rawSize;
+    uint32_t compressedSize;
+  };
+
+  struct IndexEntry
+  {
+    uint64_t offset; //!< of the chunk header
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    double tMin; //!< earliest record time in the chunk
+    double tMax; //!< latest record time in the chunk
+  };
+};
+
+/**
+ * Random-access reader of compressed trace files.
+ */
+class CompressedTraceReader
+{
+public:
+  /**
+   * Load the chunk index.
+   * \return false if the file is missing or not a compressed trace
+   */
+  bool
+  Open (const std::string &filename)
+  {
+    m_fd = open (filename.c_str (), O_RDONLY);
+    if (m_fd < 0)
+      {
+        return false;
+      }
+    struct stat st;
+    if (fstat (m_fd, &st) != 0 || st.st_size < 24)
+      {
+        return false;
+      }
+    char magic[8];
+    uint64_t count;
+    if (pread (m_fd, magic, 8, st.st_size - 8) != 8
+        || std::memcmp (magic, CompressedTraceFormat::INDEX_MAGIC, 8) != 0
+        || pread (m_fd, &count, 8, st.st_size - 16) != 8)
+      {
+        return false;
+      }
+    // A corrupt count must not size the index beyond what the file holds
+    const uint64_t entry = sizeof (CompressedTraceFormat::IndexEntry);
+    const uint64_t room = st.st_size - 24;
+    if (count > room / entry)
+      {
+        return false;
+      }
+    m_index.resize (count);
+    size_t bytes = count * entry;
+    off_t indexStart = st.st_size - 16 - bytes;
+    if (pread (m_fd, m_index.data (), bytes, indexStart) != static_cast<ssize_t> (bytes))
+      {
+        return false;
+      }
+    for (const CompressedTraceFormat::IndexEntry &e : m_index)
+      {
+        if (e.offset < 8 || e.offset > static_cast<uint64_t> (indexStart)
+            || indexStart - e.offset
+                   < sizeof (CompressedTraceFormat::ChunkHeader) + uint64_t (e.compressedSize))
+          {
+            m_index.clear ();
+            return false;
+          }
+      }
+    return true;
+  }
+
+  ~CompressedTraceReader ()
+  {
+    if (m_fd >= 0)
+      {
+        close (m_fd);
+      }
+  }
+
+  const std::vector<CompressedTraceFormat::IndexEntry> &
+  GetIndex (void) const
+  {
+    return m_index;
+  }
+
+  /**
+   * \return the chunks holding records in [from, to]
+   */
+  std::vector<size_t>
+  FindChunks (double from, double to) const
+  {
+    std::vector<size_t> chunks;
+    for (size_t i = 0; i < m_index.size (); i++)
+      {
+        if (m_index[i].tMax >= from && m_index[i].tMin <= to)
+          {
+            chunks.push_back (i);
+          }
+      }
+    return chunks;
+  }
+
+  /**
+   * Decompress one chunk.
+   * \return false if it cannot be read or is corrupt
+   */
+  bool
+  ReadChunk (size_t i, std::string &out) const
+  {
+    const CompressedTraceFormat::IndexEntry &e = m_index[i];
+    std::vector<uint8_t> block (e.compressedSize);
+    off_t pos = e.offset + sizeof (CompressedTraceFormat::ChunkHeader);
+    if (pread (m_fd, block.data (), block.size (), pos) != static_cast<ssize_t> (block.size ()))
+      {
+        return false;
+      }
+    out.resize (e.rawSize);
+    return LzCodec::Decompress (block.data (), block.size (),
+                                reinterpret_cast<uint8_t *> (&out[0]), e.rawSize);
+  }
+
+  /**
+   * Decompress the chunks covering [from, to] in parallel on up to
+   * nThreads workers and concatenate them in file order.  Records of the
+   * boundary chunks outside the range are kept; filter them by their time
+   * column.
+   * \return false if any chunk is corrupt
+   */
+  bool
+  ReadRange (double from, double to, std::string &out, unsigned nThreads = 0) const
+  {
+    std::vector<size_t> chunks = FindChunks (from, to);
+    std::vector<std::string> parts (chunks.size ());
+    if (nThreads == 0)
+      {
+        nThreads = std::max (1u, std::thread::hardware_concurrency ());
+      }
+    nThreads = std::min<size_t> (nThreads, std::max<size_t> (chunks.size (), 1));
+    std::vector<std::future<bool>> workers;
+    for (unsigned w = 0; w < nThreads; w++)
+      {
+        workers.push_back (std::async (std::launch::async, [&, w] () {
+          bool ok = true;
+          for (size_t k = w; k < chunks.size (); k += nThreads)
+            {
+              ok = ReadChunk (chunks[k], parts[k]) && ok;
+            }
+          return ok;
+        }));
+      }
+    bool ok = true;
+    for (auto &w : workers)
+      {
+        ok = w.get () && ok;
+      }
+    out.clear ();
+    for (const std::string &p : parts)
+      {
+        out += p;
+      }
+    return ok;
+  }
+
+private:
+  int m_fd = -1;
+  std::vector<CompressedTraceFormat::IndexEntry> m_index;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_TRACE_COMPRESSION_H */
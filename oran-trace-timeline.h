@@ -0,0 +1,329 @@
+#ifndef ORAN_TRACE_TIMELINE_H
+#define ORAN_TRACE_TIMELINE_H
+
+#include "ns3/simulator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * One completed span.  Name and category must be string literals (or
+ * otherwise outlive the timeline): only the pointers are stored.
+ */
+struct TimelineEvent
+{
+  const char *name;
+  const char *category;
+  int64_t wallStartNs;
+  int64_t wallEndNs;
+  double simStart; //!< simulated seconds, NaN outside the simulator thread
+  double simEnd;
+};
+
+/**
+ * Append-only span buffer owned by a single thread.
+ *
+ * Events are stored in a chain of fixed-size blocks.  The owning thread is
+ * the only writer; it fills a slot and then publishes it with a release
+ * store of the block count, so the exporter can walk the chain with
+ * acquire loads while the thread keeps recording.  No lock is taken after
+ * the buffer has been registered.
+ */
+class TimelineBuffer
+{
+public:
+  static const size_t BLOCK_EVENTS = 4096;
+
+  struct Block
+  {
+    TimelineEvent events[BLOCK_EVENTS];
+    std::atomic<size_t> count{0};
+    std::atomic<Block *> next{nullptr};
+  };
+
+  TimelineBuffer (uint32_t tid, const std::string &name)
+    : m_head (new Block),
+      m_tail (m_head),
+      m_tid (tid),
+      m_name (name)
+  {
+  }
+
+  ~TimelineBuffer ()
+  {
+    Block *b = m_head;
+    while (b)
+      {
+        Block *next = b->next.load (std::memory_order_relaxed);
+        delete b;
+        b = next;
+      }
+  }
+
+  void
+  Push (const TimelineEvent &ev)
+  {
+    size_t n = m_tail->count.load (std::memory_order_relaxed);
+    if (n == BLOCK_EVENTS)
+      {
+        Block *b = new Block;
+        m_tail->next.store (b, std::memory_order_release);
+        m_tail = b;
+        n = 0;
+      }
+    m_tail->events[n] = ev;
+    m_tail->count.store (n + 1, std::memory_order_release);
+  }
+
+  const Block *
+  GetHead (void) const
+  {
+    return m_head;
+  }
+
+  uint32_t
+  GetTid (void) const
+  {
+    return m_tid;
+  }
+
+  std::string
+  GetName (void) const
+  {
+    return m_name;
+  }
+
+  void
+  SetName (const std::string &name)
+  {
+    m_name = name;
+  }
+
+private:
+  TimelineBuffer (const TimelineBuffer &) = delete;
+  TimelineBuffer &operator= (const TimelineBuffer &) = delete;
+
+  Block *m_head;
+  Block *m_tail;
+  uint32_t m_tid;
+  std::string m_name;
+};
+
+/**
+ * Collects spans from every thread and exports them as a Chrome /
+ * Perfetto trace-event JSON file.
+ *
+ * Each span is emitted twice: once in the "wall clock" process, timed by
+ * a steady clock started at Enable (), and, when it was recorded on the
+ * simulator thread, once more in the "simulated time" process, timed by
+ * Simulator::Now ().  Both copies carry the other clock in their args, so
+ * a stall on the wall-clock track can be matched to the simulated instant
+ * it happened at.
+ */
+class TraceTimeline
+{
+public:
+  static TraceTimeline &
+  Get (void)
+  {
+    static TraceTimeline instance;
+    return instance;
+  }
+
+  static bool
+  IsEnabled (void)
+  {
+    return s_enabled;
+  }
+
+  /**
+   * Start recording.  The calling thread is taken to be the simulator
+   * thread, the only one on which Simulator::Now () is sampled.
+   */
+  void
+  Enable (void)
+  {
+    m_epoch = std::chrono::steady_clock::now ();
+    t_simulatorThread = true;
+    SetThreadName ("simulator");
+    s_enabled = true;
+  }
+
+  /**
+   * Name the calling thread in the exported trace.
+   */
+  void
+  SetThreadName (const std::string &name)
+  {
+    GetThreadBuffer ().SetName (name);
+  }
+
+  int64_t
+  WallNowNs (void) const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now () - m_epoch)
+        .count ();
+  }
+
+  static double
+  SimNow (void)
+  {
+    return t_simulatorThread ? Simulator::Now ().GetSeconds () : NAN;
+  }
+
+  void
+  Record (const TimelineEvent &ev)
+  {
+    GetThreadBuffer ().Push (ev);
+  }
+
+  /**
+   * Write every span recorded so far.  Safe to call while other threads
+   * are still recording; spans published after the walk are left out.
+   *
+   * Unlike the other outputs this one does not go through TraceWriter,
+   * which records its own spans here: a writer thread started during the
+   * walk would block registering its buffer under the registry lock held
+   * by the walk, and the walk would then wait on it for back-pressure.
+   */
+  bool
+  Write (const std::string &filename) const
+  {
+    std::ofstream out (filename.c_str (), std::ios_base::out | std::ios_base::trunc);
+    if (!out.is_open ())
+      {
+        return false;
+      }
+    out << std::setprecision (15);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\"wall clock\"}},\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,"
+           "\"args\":{\"name\":\"simulated time\"}}";
+    std::lock_guard<std::mutex> lock (m_registryMutex);
+    for (const auto &buffer : m_buffers)
+      {
+        for (int pid = 1; pid <= 2; pid++)
+          {
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"tid\":" << buffer->GetTid () << ",\"args\":{\"name\":\"" << buffer->GetName ()
+                << "\"}}";
+          }
+        for (const TimelineBuffer::Block *b = buffer->GetHead (); b;
+             b = b->next.load (std::memory_order_acquire))
+          {
+            size_t n = b->count.load (std::memory_order_acquire);
+            for (size_t i = 0; i < n; i++)
+              {
+                WriteEvent (out, buffer->GetTid (), b->events[i]);
+              }
+          }
+      }
+    out << "\n]}\n";
+    return true;
+  }
+
+private:
+  TraceTimeline () = default;
+
+  TimelineBuffer &
+  GetThreadBuffer (void)
+  {
+    if (!t_buffer)
+      {
+        std::lock_guard<std::mutex> lock (m_registryMutex);
+        uint32_t tid = static_cast<uint32_t> (m_buffers.size () + 1);
+        m_buffers.emplace_back (new TimelineBuffer (tid, "thread " + std::to_string (tid)));
+        t_buffer = m_buffers.back ().get ();
+      }
+    return *t_buffer;
+  }
+
+  static void
+  WriteEvent (std::ostream &out, uint32_t tid, const TimelineEvent &ev)
+  {
+    double wallUs = ev.wallStartNs / 1e3;
+    double wallDurUs = (ev.wallEndNs - ev.wallStartNs) / 1e3;
+    out << ",\n{\"name\":\"" << ev.name << "\",\"cat\":\"" << ev.category
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << wallUs
+        << ",\"dur\":" << wallDurUs;
+    if (std::isnan (ev.simStart))
+      {
+        out << "}";
+        return;
+      }
+    out << ",\"args\":{\"sim_start_s\":" << ev.simStart << ",\"sim_end_s\":" << ev.simEnd
+        << "}}";
+    out << ",\n{\"name\":\"" << ev.name << "\",\"cat\":\"" << ev.category
+        << "\",\"ph\":\"X\",\"pid\":2,\"tid\":" << tid << ",\"ts\":" << ev.simStart * 1e6
+        << ",\"dur\":" << (ev.simEnd - ev.simStart) * 1e6 << ",\"args\":{\"wall_start_us\":"
+        << wallUs << ",\"wall_dur_us\":" << wallDurUs << "}}";
+  }
+
+  static inline bool s_enabled = false;
+  static inline thread_local TimelineBuffer *t_buffer = nullptr;
+  static inline thread_local bool t_simulatorThread = false;
+
+  std::chrono::steady_clock::time_point m_epoch;
+  mutable std::mutex m_registryMutex;
+  std::vector<std::unique_ptr<TimelineBuffer>> m_buffers;
+};
+
+/**
+ * Records a span from construction to Stop () (or destruction).  Does
+ * nothing unless the timeline is enabled.
+ */
+class TimelineSpan
+{
+public:
+  TimelineSpan (const char *name, const char *category)
+    : m_running (TraceTimeline::IsEnabled ())
+  {
+    if (m_running)
+      {
+        m_event.name = name;
+        m_event.category = category;
+        m_event.wallStartNs = TraceTimeline::Get ().WallNowNs ();
+        m_event.simStart = TraceTimeline::SimNow ();
+      }
+  }
+
+  ~TimelineSpan ()
+  {
+    Stop ();
+  }
+
+  void
+  Stop (void)
+  {
+    if (m_running)
+      {
+        m_event.wallEndNs = TraceTimeline::Get ().WallNowNs ();
+        m_event.simEnd = TraceTimeline::SimNow ();
+        TraceTimeline::Get ().Record (m_event);
+        m_running = false;
+      }
+  }
+
+private:
+  TimelineSpan (const TimelineSpan &) = delete;
+  TimelineSpan &operator= (const TimelineSpan &) = delete;
+
+  bool m_running;
+  TimelineEvent m_event;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_TRACE_TIMELINE_H */
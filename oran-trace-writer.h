@@ -0,0 +1,451 @@
+#ifndef ORAN_TRACE_WRITER_H
+#define ORAN_TRACE_WRITER_H
+
+#include "oran-trace-compression.h"
+#include "oran-trace-timeline.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <cstdint>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Background writer shared by every trace file of the scenario.
+ *
+ * Each open file is a Channel with two buffers.  The simulator thread fills
+ * the front buffer; when it is full the buffer is submitted, the two are
+ * swapped and the simulator carries on in the other one while a single
+ * writer thread write ()s and fsync ()s the submitted buffer.  The
+ * simulator thread only waits (back-pressure) when it fills its front
+ * buffer before the writer is done with the previous one.
+ *
+ * A compressed channel writes every submitted buffer as one LzCodec chunk
+ * in the CompressedTraceFormat layout and keeps the chunk index, appended
+ * when the channel is closed.  Compression runs on the writer thread, so
+ * the simulator thread never pays for it.
+ */
+class TraceWriter
+{
+public:
+  struct Channel
+  {
+    int fd = -1;
+    std::vector<char> buffer[2];
+    int front = 0;
+    bool compressed = false;
+    // Guarded by TraceWriter::m_mutex
+    size_t pendingBytes = 0;
+    double pendingTMin = 0;
+    double pendingTMax = 0;
+    bool pending = false;
+    bool close = false;
+    // Owned by the writer thread
+    uint64_t fileOffset = 0;
+    std::vector<uint8_t> block;
+    std::vector<CompressedTraceFormat::IndexEntry> index;
+  };
+
+  static TraceWriter &
+  Get (void)
+  {
+    static TraceWriter instance;
+    return instance;
+  }
+
+  /**
+   * Open (truncate) a file for asynchronous writing.
+   * \return the channel, or nullptr if the file cannot be opened
+   */
+  std::shared_ptr<Channel>
+  Open (const std::string &filename, size_t bufferBytes, bool compressed = false)
+  {
+    int fd = open (filename.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      {
+        return nullptr;
+      }
+    auto channel = std::make_shared<Channel> ();
+    channel->fd = fd;
+    channel->compressed = compressed;
+    channel->buffer[0].resize (bufferBytes);
+    channel->buffer[1].resize (bufferBytes);
+    std::lock_guard<std::mutex> lock (m_mutex);
+    StartLocked ();
+    return channel;
+  }
+
+  /**
+   * Hand the first bytes of the channel's front buffer to the writer
+   * thread and swap buffers.  Blocks while the previous buffer of the
+   * channel is still being written.
+   *
+   * \param close close the file once this buffer is on disk
+   * \param tMin earliest record time in the buffer (compressed channels)
+   * \param tMax latest record time in the buffer (compressed channels)
+   * \return the new front buffer
+   */
+  char *
+  Submit (const std::shared_ptr<Channel> &channel, size_t bytes, bool close, double tMin = 0,
+          double tMax = 0)
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    if (channel->pending)
+      {
+        TimelineSpan span ("trace.backpressure", "io");
+        m_backPressureWaits++;
+        m_done.wait (lock, [&channel] { return !channel->pending; });
+      }
+    channel->pending = true;
+    channel->pendingBytes = bytes;
+    channel->pendingTMin = tMin;
+    channel->pendingTMax = tMax;
+    channel->close = close;
+    channel->front = 1 - channel->front;
+    m_submitted++;
+    StartLocked ();
+    m_queue.push_back (channel);
+    m_work.notify_one ();
+    return channel->buffer[channel->front].data ();
+  }
+
+  /**
+   * Wait until every submitted buffer is on disk and stop the writer
+   * thread.  Open channels can still submit afterwards; the thread is
+   * restarted on demand.
+   */
+  void
+  Shutdown (void)
+  {
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (!m_thread.joinable ())
+        {
+          return;
+        }
+      m_stop = true;
+      m_work.notify_one ();
+    }
+    m_thread.join ();
+  }
+
+  void
+  Print (std::ostream &os) const
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    os << "Trace writer: " << m_submitted << " buffers, " << m_bytesIn << " bytes in, "
+       << m_bytesWritten << " bytes written, " << m_backPressureWaits << " back-pressure waits"
+       << std::endl;
+  }
+
+private:
+  TraceWriter () = default;
+
+  ~TraceWriter ()
+  {
+    Shutdown ();
+  }
+
+  void
+  StartLocked (void)
+  {
+    if (!m_thread.joinable ())
+      {
+        m_stop = false;
+        m_thread = std::thread (&TraceWriter::Run, this);
+      }
+  }
+
+  void
+  Run (void)
+  {
+    if (TraceTimeline::IsEnabled ())
+      {
+        TraceTimeline::Get ().SetThreadName ("trace writer");
+      }
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (true)
+      {
+        m_work.wait (lock, [this] { return m_stop || !m_queue.empty (); });
+        if (m_queue.empty ())
+          {
+            break;
+          }
+        std::shared_ptr<Channel> channel = m_queue.front ();
+        m_queue.pop_front ();
+        const char *data = channel->buffer[1 - channel->front].data ();
+        size_t bytes = channel->pendingBytes;
+        double tMin = channel->pendingTMin;
+        double tMax = channel->pendingTMax;
+        bool close = channel->close;
+        lock.unlock ();
+
+        size_t done = 0;
+        if (channel->compressed)
+          {
+            done = WriteChunk (*channel, data, bytes, tMin, tMax, close);
+          }
+        else
+          {
+            TimelineSpan span ("trace.write", "io");
+            done = WriteAll (channel->fd, data, bytes);
+          }
+        TimelineSpan span ("trace.fsync", "io");
+        fsync (channel->fd);
+        if (close)
+          {
+            ::close (channel->fd);
+            channel->fd = -1;
+          }
+        span.Stop ();
+
+        lock.lock ();
+        m_bytesIn += bytes;
+        m_bytesWritten += done;
+        channel->pending = false;
+        m_done.notify_all ();
+      }
+  }
+
+  static size_t
+  WriteAll (int fd, const void *data, size_t bytes)
+  {
+    const char *p = static_cast<const char *> (data);
+    size_t done = 0;
+    while (done < bytes)
+      {
+        ssize_t n = write (fd, p + done, bytes - done);
+        if (n <= 0)
+          {
+            break;
+          }
+        done += n;
+      }
+    return done;
+  }
+
+  /**
+   * Compress and append one chunk, and the index if the channel closes.
+   * \return bytes written
+   */
+  static size_t
+  WriteChunk (Channel &channel, const char *data, size_t bytes, double tMin, double tMax,
+              bool close)
+  {
+    size_t done = 0;
+    if (channel.fileOffset == 0)
+      {
+        done += WriteAll (channel.fd, CompressedTraceFormat::MAGIC, 8);
+        channel.fileOffset = done;
+      }
+    if (bytes > 0)
+      {
+        TimelineSpan compressSpan ("trace.compress", "io");
+        LzCodec::Compress (reinterpret_cast<const uint8_t *> (data), bytes, channel.block);
+        compressSpan.Stop ();
+
+        TimelineSpan writeSpan ("trace.write", "io");
+        CompressedTraceFormat::ChunkHeader header;
+        header.rawSize = static_cast<uint32_t> (bytes);
+        header.compressedSize = static_cast<uint32_t> (channel.block.size ());
+        CompressedTraceFormat::IndexEntry entry;
+        entry.offset = channel.fileOffset;
+        entry.rawSize = header.rawSize;
+        entry.compressedSize = header.compressedSize;
+        entry.tMin = tMin;
+        entry.tMax = tMax;
+        channel.index.push_back (entry);
+        size_t n = WriteAll (channel.fd, &header, sizeof (header));
+        n += WriteAll (channel.fd, channel.block.data (), channel.block.size ());
+        channel.fileOffset += n;
+        done += n;
+      }
+    if (close)
+      {
+        uint64_t count = channel.index.size ();
+        done += WriteAll (channel.fd, channel.index.data (),
+                          count * sizeof (CompressedTraceFormat::IndexEntry));
+        done += WriteAll (channel.fd, &count, sizeof (count));
+        done += WriteAll (channel.fd, CompressedTraceFormat::INDEX_MAGIC, 8);
+      }
+    return done;
+  }
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_work;
+  std::condition_variable m_done;
+  std::deque<std::shared_ptr<Channel>> m_queue;
+  std::thread m_thread;
+  bool m_stop = false;
+  uint64_t m_submitted = 0;
+  uint64_t m_bytesIn = 0;
+  uint64_t m_bytesWritten = 0;
+  uint64_t m_backPressureWaits = 0;
+};
+
+/**
+ * Output stream on a TraceWriter channel, a drop-in replacement for
+ * std::ofstream in the trace exporters.
+ *
+ * Formatting goes straight into the front buffer.  A full buffer is
+ * submitted to the writer thread; std::endl / flush () do not submit, so
+ * line-oriented traces still reach the writer in large blocks.  Close ()
+ * or the destructor submit the last buffer and return without waiting for
+ * the disk.
+ *
+ * A compressed TraceFile cuts its buffers at the last complete line, so
+ * every chunk holds whole records, and tracks the time range of each
+ * chunk from SetTime (), to be called with the time of every record before
+ * writing it.
+ */
+class TraceFile : public std::ostream
+{
+public:
+  explicit TraceFile (const std::string &filename, size_t bufferBytes = 1 << 20,
+                      bool compressed = false)
+    : std::ostream (nullptr),
+      m_buf (filename, bufferBytes, compressed)
+  {
+    rdbuf (&m_buf);
+    if (!m_buf.IsOpen ())
+      {
+        setstate (std::ios_base::badbit);
+      }
+  }
+
+  ~TraceFile ()
+  {
+    Close ();
+  }
+
+  bool
+  is_open (void) const
+  {
+    return m_buf.IsOpen ();
+  }
+
+  void
+  Close (void)
+  {
+    m_buf.Close ();
+  }
+
+  /**
+   * Set the time of the record about to be written.
+   */
+  void
+  SetTime (double t)
+  {
+    m_buf.SetTime (t);
+  }
+
+private:
+  class Buf : public std::streambuf
+  {
+  public:
+    Buf (const std::string &filename, size_t bufferBytes, bool compressed)
+      : m_channel (TraceWriter::Get ().Open (filename, bufferBytes, compressed)),
+        m_size (bufferBytes),
+        m_compressed (compressed)
+    {
+      if (m_channel)
+        {
+          char *front = m_channel->buffer[m_channel->front].data ();
+          setp (front, front + m_size);
+        }
+    }
+
+    bool
+    IsOpen (void) const
+    {
+      return m_channel != nullptr;
+    }
+
+    void
+    Close (void)
+    {
+      if (m_channel)
+        {
+          TraceWriter::Get ().Submit (m_channel, pptr () - pbase (), true, m_tMin, m_tMax);
+          m_channel = nullptr;
+          setp (nullptr, nullptr);
+        }
+    }
+
+    void
+    SetTime (double t)
+    {
+      m_time = t;
+      if (pptr () == pbase ())
+        {
+          m_tMin = m_tMax = t;
+        }
+      else
+        {
+          m_tMin = std::min (m_tMin, t);
+          m_tMax = std::max (m_tMax, t);
+        }
+    }
+
+  protected:
+    int_type
+    overflow (int_type ch) override
+    {
+      if (!m_channel)
+        {
+          return traits_type::eof ();
+        }
+      size_t bytes = pptr () - pbase ();
+      size_t keep = 0;
+      if (m_compressed)
+        {
+          // Carry the incomplete last record over to the next chunk
+          const char *nl = static_cast<const char *> (memrchr (pbase (), '\n', bytes));
+          keep = nl ? pbase () + bytes - (nl + 1) : 0;
+        }
+      const char *tail = pbase () + bytes - keep;
+      char *front = TraceWriter::Get ().Submit (m_channel, bytes - keep, false, m_tMin, m_tMax);
+      std::memcpy (front, tail, keep);
+      setp (front, front + m_size);
+      pbump (static_cast<int> (keep));
+      m_tMin = m_tMax = m_time;
+      if (!traits_type::eq_int_type (ch, traits_type::eof ()))
+        {
+          *pptr () = traits_type::to_char_type (ch);
+          pbump (1);
+        }
+      return traits_type::not_eof (ch);
+    }
+
+    int
+    sync (void) override
+    {
+      return 0;
+    }
+
+  private:
+    std::shared_ptr<TraceWriter::Channel> m_channel;
+    size_t m_size;
+    bool m_compressed;
+    double m_time = 0;
+    double m_tMin = 0;
+    double m_tMax = 0;
+  };
+
+  Buf m_buf;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_TRACE_WRITER_H */
@@ -0,0 +1,330 @@
+#ifndef ORAN_TRAJECTORY_MOBILITY_H
+#define ORAN_TRAJECTORY_MOBILITY_H
+
+#include "ns3/mobility-module.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+/**
+ * Binary trajectory file layout, written by fcd_to_trajectory.py.
+ *
+ * A header is followed by one track entry per UE and then by the
+ * waypoints of every track, in increasing time, all little-endian.
+ */
+struct TrajectoryFormat
+{
+  static constexpr const char *MAGIC = "ORANTRJ1";
+
+  struct Header
+  {
+    char magic[8];
+    uint32_t nTracks;
+    uint32_t chunkWaypoints; //!< waypoints prefetched at a time
+  };
+
+  struct Track
+  {
+    uint64_t offset; //!< byte offset of the first waypoint
+    uint64_t count;
+  };
+
+  struct Waypoint
+  {
+    double t; //!< (s)
+    float x;  //!< (m)
+    float y;  //!< (m)
+  };
+};
+
+/**
+ * A trajectory file mapped read-only into memory.
+ *
+ * Nothing is read at open beyond the header and track table: waypoints are
+ * paged in by the kernel as models touch them, Prefetch () asks for the
+ * next chunk of a track ahead of time and Release () lets the kernel drop
+ * chunks a track has moved past, so the resident set follows the
+ * simulated time instead of the file size.
+ */
+class TrajectoryFile : public SimpleRefCount<TrajectoryFile>
+{
+public:
+  TrajectoryFile ()
+    : m_fd (-1),
+      m_data (nullptr),
+      m_size (0),
+      m_header (nullptr),
+      m_tracks (nullptr)
+  {
+  }
+
+  ~TrajectoryFile ()
+  {
+    if (m_data)
+      {
+        munmap (m_data, m_size);
+      }
+    if (m_fd >= 0)
+      {
+        close (m_fd);
+      }
+  }
+
+  /**
+   * Map the file and check its track table.
+   * \return false if the file is missing or not a valid trajectory file
+   */
+  bool
+  Open (const std::string &filename)
+  {
+    m_fd = open (filename.c_str (), O_RDONLY);
+    struct stat st;
+    if (m_fd < 0 || fstat (m_fd, &st) != 0
+        || static_cast<size_t> (st.st_size) < sizeof (TrajectoryFormat::Header))
+      {
+        return false;
+      }
+    m_size = st.st_size;
+    void *data = mmap (nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+      {
+        return false;
+      }
+    m_data = static_cast<uint8_t *> (data);
+    // Tracks are read sequentially but interleaved: no kernel readahead
+    madvise (m_data, m_size, MADV_RANDOM);
+    m_header = reinterpret_cast<const TrajectoryFormat::Header *> (m_data);
+    m_tracks = reinterpret_cast<const TrajectoryFormat::Track *> (m_header + 1);
+    if (std::memcmp (m_header->magic, TrajectoryFormat::MAGIC, 8) != 0
+        || sizeof (TrajectoryFormat::Header)
+                   + m_header->nTracks * sizeof (TrajectoryFormat::Track)
+               > m_size)
+      {
+        return false;
+      }
+    for (uint32_t i = 0; i < m_header->nTracks; i++)
+      {
+        const TrajectoryFormat::Track &t = m_tracks[i];
+        if (t.count == 0 || t.offset % alignof (TrajectoryFormat::Waypoint) != 0
+            || t.offset + t.count * sizeof (TrajectoryFormat::Waypoint) > m_size)
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  uint32_t
+  GetNTracks (void) const
+  {
+    return m_header->nTracks;
+  }
+
+  uint32_t
+  GetChunkWaypoints (void) const
+  {
+    return std::max<uint32_t> (m_header->chunkWaypoints, 1);
+  }
+
+  const TrajectoryFormat::Waypoint *
+  GetWaypoints (uint32_t track) const
+  {
+    return reinterpret_cast<const TrajectoryFormat::Waypoint *> (m_data
+                                                                 + m_tracks[track].offset);
+  }
+
+  uint64_t
+  GetCount (uint32_t track) const
+  {
+    return m_tracks[track].count;
+  }
+
+  /**
+   * Ask the kernel to read n waypoints from w in the background.
+   */
+  void
+  Prefetch (const TrajectoryFormat::Waypoint *w, uint64_t n) const
+  {
+    Advise (w, n, MADV_WILLNEED, false);
+  }
+
+  /**
+   * Let the kernel drop the pages wholly inside n waypoints from w.
+   */
+  void
+  Release (const TrajectoryFormat::Waypoint *w, uint64_t n) const
+  {
+    Advise (w, n, MADV_DONTNEED, true);
+  }
+
+private:
+  void
+  Advise (const TrajectoryFormat::Waypoint *w, uint64_t n, int advice, bool inner) const
+  {
+    static const uintptr_t page = sysconf (_SC_PAGESIZE);
+    uintptr_t from = reinterpret_cast<uintptr_t> (w);
+    uintptr_t to = reinterpret_cast<uintptr_t> (w + n);
+    from = inner ? (from + page - 1) / page * page : from / page * page;
+    to = inner ? to / page * page : (to + page - 1) / page * page;
+    to = std::min (to, reinterpret_cast<uintptr_t> (m_data) + m_size);
+    if (to > from)
+      {
+        madvise (reinterpret_cast<void *> (from), to - from, advice);
+      }
+  }
+
+  int m_fd;
+  uint8_t *m_data;
+  size_t m_size;
+  const TrajectoryFormat::Header *m_header;
+  const TrajectoryFormat::Track *m_tracks;
+};
+
+/**
+ * Mobility model following one track of a trajectory file.
+ *
+ * The position is interpolated linearly between the waypoints around the
+ * current time only when asked for, from a cursor that moves forward with
+ * time, so the model schedules no events of its own.  Before the first and
+ * after the last waypoint the UE stands still there.  SetPosition ()
+ * translates the whole track so that it passes through the new position
+ * now.
+ */
+class TrajectoryMobilityModel : public MobilityModel
+{
+public:
+  static TypeId
+  GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::TrajectoryMobilityModel")
+                            .SetParent<MobilityModel> ()
+                            .SetGroupName ("Mobility")
+                            .AddConstructor<TrajectoryMobilityModel> ();
+    return tid;
+  }
+
+  TrajectoryMobilityModel ()
+    : m_w (nullptr),
+      m_n (0),
+      m_height (1.5),
+      m_cursor (0),
+      m_prefetched (0),
+      m_released (0)
+  {
+  }
+
+  /**
+   * Follow a track of a file at a fixed height (m).
+   */
+  void
+  SetTrajectory (Ptr<TrajectoryFile> file, uint32_t track, double height = 1.5)
+  {
+    m_file = file;
+    m_w = file->GetWaypoints (track);
+    m_n = file->GetCount (track);
+    m_height = height;
+    m_offset = Vector ();
+    m_cursor = 0;
+    m_released = 0;
+    m_prefetched = std::min<uint64_t> (file->GetChunkWaypoints (), m_n);
+    file->Prefetch (m_w, m_prefetched);
+  }
+
+private:
+  /**
+   * Move the cursor to the last waypoint at or before t.
+   */
+  void
+  Seek (double t) const
+  {
+    if (t < m_w[m_cursor].t)
+      {
+        // Time went back (a new run): search from the start
+        auto before = [] (double v, const TrajectoryFormat::Waypoint &p) { return v < p.t; };
+        const TrajectoryFormat::Waypoint *w = std::upper_bound (m_w, m_w + m_n, t, before);
+        m_cursor = w == m_w ? 0 : w - m_w - 1;
+        m_released = std::min (m_released, m_cursor);
+      }
+    while (m_cursor + 1 < m_n && m_w[m_cursor + 1].t <= t)
+      {
+        m_cursor++;
+      }
+    const uint64_t chunk = m_file->GetChunkWaypoints ();
+    if (m_cursor + chunk / 2 >= m_prefetched && m_prefetched < m_n)
+      {
+        uint64_t n = std::min (chunk, m_n - m_prefetched);
+        m_file->Prefetch (m_w + m_prefetched, n);
+        m_prefetched += n;
+      }
+    if (m_cursor >= m_released + 2 * chunk)
+      {
+        m_file->Release (m_w + m_released, chunk);
+        m_released += chunk;
+      }
+  }
+
+  Vector
+  DoGetPosition (void) const override
+  {
+    double t = Simulator::Now ().GetSeconds ();
+    Seek (t);
+    const TrajectoryFormat::Waypoint &a = m_w[m_cursor];
+    double x = a.x;
+    double y = a.y;
+    if (m_cursor + 1 < m_n && t > a.t)
+      {
+        const TrajectoryFormat::Waypoint &b = m_w[m_cursor + 1];
+        double f = (t - a.t) / (b.t - a.t);
+        x += f * (b.x - a.x);
+        y += f * (b.y - a.y);
+      }
+    return Vector (x + m_offset.x, y + m_offset.y, m_height + m_offset.z);
+  }
+
+  void
+  DoSetPosition (const Vector &position) override
+  {
+    Vector current = DoGetPosition ();
+    m_offset.x += position.x - current.x;
+    m_offset.y += position.y - current.y;
+    m_offset.z += position.z - current.z;
+    NotifyCourseChange ();
+  }
+
+  Vector
+  DoGetVelocity (void) const override
+  {
+    double t = Simulator::Now ().GetSeconds ();
+    Seek (t);
+    if (m_cursor + 1 >= m_n || t < m_w[m_cursor].t)
+      {
+        return Vector ();
+      }
+    const TrajectoryFormat::Waypoint &a = m_w[m_cursor];
+    const TrajectoryFormat::Waypoint &b = m_w[m_cursor + 1];
+    double dt = b.t - a.t;
+    return Vector ((b.x - a.x) / dt, (b.y - a.y) / dt, 0.0);
+  }
+
+  Ptr<TrajectoryFile> m_file;
+  const TrajectoryFormat::Waypoint *m_w;
+  uint64_t m_n;
+  double m_height;
+  Vector m_offset; //!< translation applied by SetPosition ()
+  mutable uint64_t m_cursor;
+  mutable uint64_t m_prefetched; //!< waypoints asked for so far
+  mutable uint64_t m_released;   //!< waypoints released so far
+};
+
+} // namespace ns3
+
+#endif /* ORAN_TRAJECTORY_MOBILITY_H */
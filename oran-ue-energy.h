@@ -0,0 +1,232 @@
+#ifndef ORAN_UE_ENERGY_H
+#define ORAN_UE_ENERGY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Power of a UE in each RRC/DRX state and cost of its radio activity, with
+ * defaults in the range of measured LTE/5G handsets.
+ */
+struct UeEnergyConfig
+{
+  double idlePower = 0.015;       //!< RRC idle with paging DRX (W)
+  double drxOnPower = 1.0;        //!< connected, inactivity timer running (W)
+  double drxSleepPower = 0.04;    //!< connected, long DRX cycle average (W)
+  double txPower = 1.6;           //!< extra power while transmitting (W)
+  double rxPower = 1.2;           //!< extra power while receiving (W)
+  double tti = 0.000125;          //!< air time of one transport block (s)
+  double inactivityTimer = 0.1;   //!< DRX inactivity timer (s)
+  double handoverEnergy = 0.05;   //!< random access and reconfiguration of a handover (J)
+  double batteryCapacity = 55440; //!< 4000 mAh at 3.85 V (J)
+};
+
+/**
+ * Energy of every UE from its RRC state and its transmissions.
+ *
+ * A connected UE is awake (DRX on) until inactivityTimer after its last
+ * transport block and in long-cycle DRX sleep afterwards; a UE in RRC idle
+ * only wakes up for paging.  The time spent in each state and the air time
+ * spent transmitting and receiving are accumulated per UE in arrays (one
+ * array per state, indexed by UE), brought up to date lazily whenever an
+ * event of that UE is seen or Update () is called, and priced from one
+ * power per state.
+ */
+class UeEnergyModel
+{
+public:
+  enum State
+  {
+    IDLE,
+    DRX_ON,
+    DRX_SLEEP,
+    N_STATES
+  };
+
+  explicit UeEnergyModel (const UeEnergyConfig &config = UeEnergyConfig ())
+    : m_config (config),
+      m_power {config.idlePower, config.drxOnPower, config.drxSleepPower}
+  {
+  }
+
+  /**
+   * Track a UE, initially in RRC idle.
+   * \return its index
+   */
+  uint32_t
+  AddUe (uint64_t imsi, double now)
+  {
+    uint32_t i = m_connected.size ();
+    m_index[imsi] = i;
+    m_connected.push_back (false);
+    m_lastUpdate.push_back (now);
+    m_lastActivity.push_back (-m_config.inactivityTimer);
+    for (std::vector<double> &d : m_duration)
+      {
+        d.push_back (0.0);
+      }
+    m_txTime.push_back (0.0);
+    m_rxTime.push_back (0.0);
+    m_handovers.push_back (0);
+    return i;
+  }
+
+  void
+  NotifyConnected (uint64_t imsi, bool connected, double now)
+  {
+    uint32_t i;
+    if (Find (imsi, now, i))
+      {
+        m_connected[i] = connected;
+      }
+  }
+
+  void
+  NotifyTx (uint64_t imsi, double now)
+  {
+    uint32_t i;
+    if (Find (imsi, now, i))
+      {
+        m_txTime[i] += m_config.tti;
+        m_lastActivity[i] = now;
+      }
+  }
+
+  void
+  NotifyRx (uint64_t imsi, double now)
+  {
+    uint32_t i;
+    if (Find (imsi, now, i))
+      {
+        m_rxTime[i] += m_config.tti;
+        m_lastActivity[i] = now;
+      }
+  }
+
+  void
+  NotifyHandover (uint64_t imsi, double now)
+  {
+    uint32_t i;
+    if (Find (imsi, now, i))
+      {
+        m_handovers[i]++;
+        m_lastActivity[i] = now;
+      }
+  }
+
+  /**
+   * Bring the state durations of every UE up to now.
+   */
+  void
+  Update (double now)
+  {
+    for (uint32_t i = 0; i < m_connected.size (); i++)
+      {
+        Advance (i, now);
+      }
+  }
+
+  /**
+   * \return the energy UE i spent until its last update (J)
+   */
+  double
+  GetEnergy (uint32_t i) const
+  {
+    double energy = m_txTime[i] * m_config.txPower + m_rxTime[i] * m_config.rxPower
+                    + m_handovers[i] * m_config.handoverEnergy;
+    for (uint32_t s = 0; s < N_STATES; s++)
+      {
+        energy += m_duration[s][i] * m_power[s];
+      }
+    return energy;
+  }
+
+  /**
+   * \return the share of UE i's battery spent until its last update
+   */
+  double
+  GetBatteryDrain (uint32_t i) const
+  {
+    return GetEnergy (i) / m_config.batteryCapacity;
+  }
+
+  const UeEnergyConfig &
+  GetConfig (void) const
+  {
+    return m_config;
+  }
+
+  double
+  GetDuration (uint32_t i, State s) const
+  {
+    return m_duration[s][i];
+  }
+
+  uint32_t
+  GetHandovers (uint32_t i) const
+  {
+    return m_handovers[i];
+  }
+
+  uint32_t
+  GetN (void) const
+  {
+    return m_connected.size ();
+  }
+
+private:
+  bool
+  Find (uint64_t imsi, double now, uint32_t &i)
+  {
+    auto it = m_index.find (imsi);
+    if (it == m_index.end ())
+      {
+        return false;
+      }
+    i = it->second;
+    Advance (i, now);
+    return true;
+  }
+
+  void
+  Advance (uint32_t i, double now)
+  {
+    double from = m_lastUpdate[i];
+    if (now <= from)
+      {
+        return;
+      }
+    if (m_connected[i])
+      {
+        double awake = std::max (m_lastActivity[i] + m_config.inactivityTimer, from);
+        double awakeUntil = std::min (awake, now);
+        m_duration[DRX_ON][i] += awakeUntil - from;
+        m_duration[DRX_SLEEP][i] += now - awakeUntil;
+      }
+    else
+      {
+        m_duration[IDLE][i] += now - from;
+      }
+    m_lastUpdate[i] = now;
+  }
+
+  UeEnergyConfig m_config;
+  std::array<double, N_STATES> m_power;
+  std::unordered_map<uint64_t, uint32_t> m_index; //!< IMSI to UE index
+  std::vector<uint8_t> m_connected;
+  std::vector<double> m_lastUpdate;
+  std::vector<double> m_lastActivity;
+  std::array<std::vector<double>, N_STATES> m_duration;
+  std::vector<double> m_txTime;
+  std::vector<double> m_rxTime;
+  std::vector<uint32_t> m_handovers;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_UE_ENERGY_H */
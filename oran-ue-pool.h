@@ -0,0 +1,129 @@
+#ifndef ORAN_UE_POOL_H
+#define ORAN_UE_POOL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Pre-built UE nodes and devices lent to sessions as they arrive.
+ *
+ * Building and attaching a UE stack costs far more than moving an
+ * existing one, and ns-3 cannot tear one down mid-run, so all devices are
+ * built at setup and a session borrows one in O(1): the pool hands out the
+ * most recently released device first and remembers the owner (the
+ * logical UE) of every device.  A session that finds no free device is a
+ * miss; SizeForLoad () picks a pool size that keeps misses rare.
+ */
+class UeDevicePool
+{
+public:
+  explicit UeDevicePool (uint32_t nDevices = 0)
+    : m_owner (nDevices, -1),
+      m_hits (0),
+      m_misses (0),
+      m_peak (0)
+  {
+    for (uint32_t d = nDevices; d > 0; d--)
+      {
+        m_free.push_back (d - 1);
+      }
+  }
+
+  /**
+   * Smallest pool that serves sessions offered at the given traffic
+   * (mean number of concurrent sessions, in Erlang) with a probability of
+   * finding no free device of at most blocking, from the Erlang B formula.
+   */
+  static uint32_t
+  SizeForLoad (double erlangs, double blocking, uint32_t maxDevices)
+  {
+    double b = 1.0;
+    uint32_t n = 0;
+    while (b > blocking && n < maxDevices)
+      {
+        n++;
+        b = erlangs * b / (n + erlangs * b);
+      }
+    return std::max<uint32_t> (n, 1);
+  }
+
+  /**
+   * Lend a device to a logical UE.
+   * \return whether a device was free (a hit), set in device
+   */
+  bool
+  Acquire (uint32_t owner, uint32_t &device)
+  {
+    if (m_free.empty ())
+      {
+        m_misses++;
+        return false;
+      }
+    m_hits++;
+    device = m_free.back ();
+    m_free.pop_back ();
+    m_owner[device] = owner;
+    m_peak = std::max<uint32_t> (m_peak, GetInUse ());
+    return true;
+  }
+
+  void
+  Release (uint32_t device)
+  {
+    m_owner[device] = -1;
+    m_free.push_back (device);
+  }
+
+  /**
+   * \return the logical UE using a device, or -1 if it is free
+   */
+  int32_t
+  GetOwner (uint32_t device) const
+  {
+    return m_owner[device];
+  }
+
+  uint32_t
+  GetN (void) const
+  {
+    return m_owner.size ();
+  }
+
+  uint32_t
+  GetInUse (void) const
+  {
+    return m_owner.size () - m_free.size ();
+  }
+
+  uint32_t
+  GetPeakInUse (void) const
+  {
+    return m_peak;
+  }
+
+  uint64_t
+  GetHits (void) const
+  {
+    return m_hits;
+  }
+
+  uint64_t
+  GetMisses (void) const
+  {
+    return m_misses;
+  }
+
+private:
+  std::vector<int32_t> m_owner;
+  std::vector<uint32_t> m_free; //!< free devices, the last released on top
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint32_t m_peak;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_UE_POOL_H */
@@ -0,0 +1,243 @@
+#ifndef ORAN_WHAT_IF_H
+#define ORAN_WHAT_IF_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Outcome of one candidate policy over the lookahead horizon.
+ */
+struct WhatIfOutcome
+{
+  double energy = 0.0; //!< (J)
+  double bits = 0.0;   //!< delivered
+  bool valid = false;  //!< the child reported before exiting
+
+  /**
+   * \return whether this outcome beats other: more bits per joule, or less
+   * energy when neither delivered anything
+   */
+  bool
+  IsBetterThan (const WhatIfOutcome &other) const
+  {
+    if (!other.valid || !valid)
+      {
+        return valid;
+      }
+    if (bits > 0 || other.bits > 0)
+      {
+        return bits * other.energy > other.bits * energy;
+      }
+    return energy < other.energy;
+  }
+};
+
+/**
+ * What-if runs of candidate policies in forked copies of the simulation.
+ *
+ * Fork () makes one child process per candidate at a decision point.  Each
+ * child returns from Fork () with its candidate index, applies that
+ * candidate and keeps simulating until it calls Report (), which sends its
+ * outcome to the parent over a pipe and exits without running any
+ * destructor.  The parent returns from Fork () once every child has
+ * reported or died.  Children share the parent's memory copy-on-write, so
+ * a fork costs only the pages a child writes during its horizon.
+ *
+ * Only the calling thread survives in a child: the caller must keep the
+ * children away from state owned by other threads.
+ */
+class WhatIfLookahead
+{
+public:
+  WhatIfLookahead ()
+    : m_fd (-1),
+      m_forks (0),
+      m_failures (0)
+  {
+  }
+
+  /**
+   * Run n candidates in parallel children.
+   * \return -1 in the parent, with every outcome in GetOutcomes (), or the
+   * candidate of the calling child
+   */
+  int32_t
+  Fork (uint32_t n)
+  {
+    std::cout.flush ();
+    std::clog.flush ();
+    std::fflush (nullptr);
+    std::vector<int> fds;
+    std::vector<pid_t> pids;
+    for (uint32_t k = 0; k < n; k++)
+      {
+        int p[2];
+        pid_t pid = -1;
+        if (pipe (p) == 0)
+          {
+            pid = fork ();
+            if (pid < 0)
+              {
+                close (p[0]);
+                close (p[1]);
+              }
+          }
+        if (pid == 0)
+          {
+            close (p[0]);
+            for (int fd : fds)
+              {
+                close (fd);
+              }
+            // Children run silently: their logs would interleave with the parent's
+            int null = open ("/dev/null", O_WRONLY);
+            dup2 (null, STDOUT_FILENO);
+            dup2 (null, STDERR_FILENO);
+            close (null);
+            m_fd = p[1];
+            return k;
+          }
+        if (pid > 0)
+          {
+            close (p[1]);
+            m_forks++;
+          }
+        else
+          {
+            m_failures++;
+          }
+        fds.push_back (pid > 0 ? p[0] : -1);
+        pids.push_back (pid);
+      }
+    m_outcomes.assign (n, WhatIfOutcome ());
+    for (uint32_t k = 0; k < n; k++)
+      {
+        if (fds[k] < 0)
+          {
+            continue;
+          }
+        WhatIfOutcome outcome;
+        m_outcomes[k].valid = ReadAll (fds[k], &outcome, sizeof (outcome)) && outcome.valid;
+        if (m_outcomes[k].valid)
+          {
+            m_outcomes[k] = outcome;
+          }
+        close (fds[k]);
+        int status;
+        while (waitpid (pids[k], &status, 0) < 0 && errno == EINTR)
+          {
+          }
+        m_failures += !m_outcomes[k].valid;
+      }
+    return -1;
+  }
+
+  /**
+   * Send the outcome of this child's candidate to the parent and exit.
+   */
+  [[noreturn]] void
+  Report (WhatIfOutcome outcome)
+  {
+    outcome.valid = true;
+    const char *p = reinterpret_cast<const char *> (&outcome);
+    size_t left = sizeof (outcome);
+    while (left > 0)
+      {
+        ssize_t n = write (m_fd, p, left);
+        if (n < 0 && errno == EINTR)
+          {
+            continue;
+          }
+        if (n <= 0)
+          {
+            break;
+          }
+        p += n;
+        left -= n;
+      }
+    _exit (0);
+  }
+
+  /**
+   * \return whether this process is a child of Fork ()
+   */
+  bool
+  IsChild (void) const
+  {
+    return m_fd >= 0;
+  }
+
+  const std::vector<WhatIfOutcome> &
+  GetOutcomes (void) const
+  {
+    return m_outcomes;
+  }
+
+  /**
+   * \return the index of the best outcome of the last Fork (), or 0
+   */
+  uint32_t
+  GetBest (void) const
+  {
+    uint32_t best = 0;
+    for (uint32_t k = 1; k < m_outcomes.size (); k++)
+      {
+        best = m_outcomes[k].IsBetterThan (m_outcomes[best]) ? k : best;
+      }
+    return best;
+  }
+
+  uint64_t
+  GetForks (void) const
+  {
+    return m_forks;
+  }
+
+  /**
+   * \return children that could not be forked or died without reporting
+   */
+  uint64_t
+  GetFailures (void) const
+  {
+    return m_failures;
+  }
+
+private:
+  static bool
+  ReadAll (int fd, void *buffer, size_t size)
+  {
+    char *p = static_cast<char *> (buffer);
+    while (size > 0)
+      {
+        ssize_t n = read (fd, p, size);
+        if (n < 0 && errno == EINTR)
+          {
+            continue;
+          }
+        if (n <= 0)
+          {
+            return false;
+          }
+        p += n;
+        size -= n;
+      }
+    return true;
+  }
+
+  int m_fd; //!< pipe to the parent, in a child
+  uint64_t m_forks;
+  uint64_t m_failures;
+  std::vector<WhatIfOutcome> m_outcomes;
+};
+
+} // namespace ns3
+
+#endif /* ORAN_WHAT_IF_H */
@@ -0,0 +1,221 @@
+import argparse
+import fcntl
+import math
+import os
+import statistics
+import struct
+import sys
+
+# Formato do repositório de resultados: ver oran-results-store.h
+
+
+def sanitize_name(name):
+    """Mesma regra de ResultsStore::SanitizeName para nomes de métricas."""
+    return "".join(c if c.isalnum() or c in "_-." else "_" for c in name)
+
+
+def read_index(store):
+    """
+    Lê o índice de execuções do repositório.
+
+    Parâmetros:
+    store (str): Diretório do repositório.
+
+    Retorna:
+    list: Tuplas (linha, semente, run, dict de parâmetros), só das linhas
+    confirmadas; para linhas repetidas vale a última gravação.
+    """
+    try:
+        with open(os.path.join(store, "rows"), "rb") as f:
+            committed = struct.unpack("<Q", f.read(8))[0]
+    except (OSError, struct.error):
+        return []
+    rows = {}
+    with open(os.path.join(store, "runs.idx")) as f:
+        for line in f:
+            fields = line.rstrip("\n").split("\t")
+            if len(fields) != 4:
+                continue
+            row = int(fields[0])
+            if row >= committed:
+                continue
+            params = dict(kv.split("=", 1) for kv in fields[3].split(",") if kv)
+            rows[row] = (row, int(fields[1]), int(fields[2]), params)
+    return [rows[r] for r in sorted(rows)]
+
+
+def read_column(store, metric, rows):
+    """
+    Lê os valores de uma métrica apenas nas linhas pedidas.
+
+    Retorna:
+    list: Valores (NaN onde a execução não registrou a métrica).
+    """
+    path = os.path.join(store, "columns", sanitize_name(metric) + ".f64")
+    if not os.path.exists(path):
+        return [math.nan] * len(rows)
+    values = []
+    with open(path, "rb") as f:
+        size = os.fstat(f.fileno()).st_size // 8
+        for row in rows:
+            if row >= size:
+                values.append(math.nan)
+                continue
+            f.seek(8 * row)
+            values.append(struct.unpack("<d", f.read(8))[0])
+    return values
+
+
+def append(store, params, seed, run, metrics):
+    """
+    Acrescenta uma execução ao repositório, com o mesmo protocolo de
+    travamento (flock em "lock") de ResultsStore::Append.
+    """
+    os.makedirs(os.path.join(store, "columns"), exist_ok=True)
+    with open(os.path.join(store, "lock"), "a+") as lock:
+        fcntl.flock(lock, fcntl.LOCK_EX)
+        rows_path = os.path.join(store, "rows")
+        fd = os.open(rows_path, os.O_RDWR | os.O_CREAT, 0o644)
+        try:
+            data = os.pread(fd, 8, 0)
+            row = struct.unpack("<Q", data)[0] if len(data) == 8 else 0
+            values = {sanitize_name(k) + ".f64": float(v) for k, v in metrics.items()}
+            # Limpa a linha nas colunas que a execução não registra, caso uma
+            # gravação interrompida tenha deixado valores nela
+            for name in os.listdir(os.path.join(store, "columns")):
+                if name.endswith(".f64"):
+                    values.setdefault(name, math.nan)
+            for name, value in values.items():
+                path = os.path.join(store, "columns", name)
+                cfd = os.open(path, os.O_RDWR | os.O_CREAT, 0o644)
+                try:
+                    have = os.fstat(cfd).st_size // 8
+                    if have < row:
+                        os.pwrite(cfd, struct.pack("<d", math.nan) * (row - have), 8 * have)
+                    os.pwrite(cfd, struct.pack("<d", value), 8 * row)
+                    os.fsync(cfd)
+                finally:
+                    os.close(cfd)
+            kv = ",".join("%s=%s" % (k, params[k]) for k in sorted(params))
+            with open(os.path.join(store, "runs.idx"), "a") as idx:
+                idx.write("%d\t%d\t%d\t%s\n" % (row, seed, run, kv))
+                idx.flush()
+                os.fsync(idx.fileno())
+            os.pwrite(fd, struct.pack("<Q", row + 1), 0)
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+            fcntl.flock(lock, fcntl.LOCK_UN)
+
+
+AGGREGATES = {
+    "count": len,
+    "mean": statistics.fmean,
+    "std": lambda v: statistics.stdev(v) if len(v) > 1 else 0.0,
+    "min": min,
+    "max": max,
+}
+
+
+def canonical(value):
+    """
+    Forma canônica de um valor de parâmetro: números na menor forma que
+    relê o mesmo valor ("10.000000" e "10" viram "10"), os demais inalterados.
+
+    Parâmetros:
+    value (str): Valor como gravado ou como escrito na consulta.
+
+    Retorna:
+    str: Valor canônico.
+    """
+    try:
+        number = float(value)
+    except ValueError:
+        return value
+    text = repr(number)
+    return text[:-2] if text.endswith(".0") else text
+
+
+def query(store, where, metrics, group_by, aggregates):
+    """
+    Filtra execuções pelos parâmetros e agrega métricas por grupo.
+
+    Parâmetros:
+    store (str): Diretório do repositório.
+    where (dict): Parâmetros que devem ter estes valores, números comparados
+        pelo valor.
+    metrics (list): Métricas a agregar.
+    group_by (list): Parâmetros que definem os grupos.
+    aggregates (list): Agregações em AGGREGATES.
+
+    Retorna:
+    list: Tuplas (grupo, {métrica: {agregação: valor}}).
+    """
+    runs = [r for r in read_index(store)
+            if all(k in r[3] and canonical(r[3][k]) == canonical(v)
+                   for k, v in where.items())]
+    rows = [r[0] for r in runs]
+    columns = {m: read_column(store, m, rows) for m in metrics}
+    groups = {}
+    for i, r in enumerate(runs):
+        key = tuple(canonical(r[3].get(g, "")) for g in group_by)
+        groups.setdefault(key, []).append(i)
+    result = []
+    for key in sorted(groups):
+        stats = {}
+        for m in metrics:
+            values = [columns[m][i] for i in groups[key] if not math.isnan(columns[m][i])]
+            stats[m] = {a: (AGGREGATES[a](values) if values else math.nan) for a in aggregates}
+        result.append((key, stats))
+    return result
+
+
+def parse_pairs(pairs):
+    out = {}
+    for p in pairs or []:
+        k, v = p.split("=", 1)
+        out[k] = v
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Consulta e grava o repositório de resultados de varreduras")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    q = sub.add_parser("query", help="Filtra e agrega execuções")
+    q.add_argument("store")
+    q.add_argument("--where", action="append", metavar="PARAM=VALOR")
+    q.add_argument("--metric", action="append", required=True)
+    q.add_argument("--group-by", action="append", default=[])
+    q.add_argument("--agg", default="count,mean,std,min,max")
+
+    a = sub.add_parser("append", help="Acrescenta uma execução")
+    a.add_argument("store")
+    a.add_argument("--param", action="append", metavar="PARAM=VALOR")
+    a.add_argument("--metric", action="append", metavar="MÉTRICA=VALOR")
+    a.add_argument("--seed", type=int, default=1)
+    a.add_argument("--run", type=int, default=1)
+
+    sub.add_parser("metrics", help="Lista as métricas gravadas").add_argument("store")
+
+    opts = parser.parse_args()
+    if opts.command == "append":
+        metrics = {k: float(v) for k, v in parse_pairs(opts.metric).items()}
+        append(opts.store, parse_pairs(opts.param), opts.seed, opts.run, metrics)
+    elif opts.command == "metrics":
+        for name in sorted(os.listdir(os.path.join(opts.store, "columns"))):
+            print(name[:-4])
+    else:
+        aggregates = opts.agg.split(",")
+        result = query(opts.store, parse_pairs(opts.where), opts.metric,
+                       opts.group_by, aggregates)
+        header = opts.group_by + ["%s.%s" % (m, a) for m in opts.metric for a in aggregates]
+        print("\t".join(header))
+        for key, stats in result:
+            values = ["%.6g" % stats[m][a] for m in opts.metric for a in aggregates]
+            print("\t".join(list(key) + values))
+
+
+if __name__ == "__main__":
+    sys.exit(main())